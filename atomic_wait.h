@@ -0,0 +1,100 @@
+#pragma once
+
+#include "stdatomic_asm.h"
+#include <linux/futex.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Ожидание изменения атомарной переменной: сначала адаптивное вращение с
+// подсказкой процессору, затем засыпание на futex(FUTEX_WAIT_PRIVATE).
+// Futex работает только с 32-битными словами, поэтому и объект ожидания 32-битный.
+//
+// Уведомляющая сторона должна изменить значение (atomic_store или любая AMO)
+// до вызова atomic_notify_*. Системный вызов делается только если на этот
+// адрес кто-то действительно спит.
+
+// Границы адаптивного бюджета вращения (число итераций cpu_relax)
+#define WAIT_SPIN_MIN 16
+#define WAIT_SPIN_MAX 65536
+#define WAIT_SPIN_INITIAL 1024
+
+// Счётчики спящих потоков, адрес объекта хешируется в одну из ячеек
+#define WAIT_TABLE_SIZE 64
+
+struct alignas(CACHE_LINE_SIZE) WaitBucket {
+    volatile uint32_t waiters;
+};
+
+inline WaitBucket wait_table[WAIT_TABLE_SIZE];
+
+// Бюджет вращения у каждого потока свой: растёт, когда значение успевает
+// смениться во время вращения, и уменьшается, когда всё равно пришлось уснуть
+inline thread_local uint32_t wait_spin_limit = WAIT_SPIN_INITIAL;
+
+inline WaitBucket* wait_bucket(volatile uint32_t* obj)
+{
+    uintptr_t addr = reinterpret_cast<uintptr_t>(obj);
+    return &wait_table[(addr >> 2) * 0x9e3779b97f4a7c15ull >> 58];
+}
+
+inline long futex(volatile uint32_t* obj, int op, uint32_t val)
+{
+    return syscall(SYS_futex, obj, op, val, nullptr, nullptr, 0);
+}
+
+// Чистое вращение без засыпания
+inline void atomic_wait_spin(volatile uint32_t* obj, uint32_t old)
+{
+    while (atomic_load_explicit(obj, __ATOMIC_ACQUIRE) == old)
+        cpu_relax();
+}
+
+// Засыпание на futex без предварительного вращения
+inline void atomic_wait_park(volatile uint32_t* obj, uint32_t old)
+{
+    WaitBucket* bucket = wait_bucket(obj);
+    while (atomic_load_explicit(obj, __ATOMIC_ACQUIRE) == old) {
+        atomic_fetch_add(&bucket->waiters, 1);
+        // Ядро заново сравнит *obj с old, так что пропустить уведомление нельзя
+        futex(obj, FUTEX_WAIT_PRIVATE, old);
+        atomic_fetch_sub(&bucket->waiters, 1);
+    }
+}
+
+// Ждёт, пока *obj не станет отличным от old
+inline void atomic_wait(volatile uint32_t* obj, uint32_t old)
+{
+    uint32_t limit = wait_spin_limit;
+    for (uint32_t i = 0; i < limit; i++) {
+        if (atomic_load_explicit(obj, __ATOMIC_ACQUIRE) != old) {
+            if (limit < WAIT_SPIN_MAX)
+                wait_spin_limit = limit + limit / 8 + 1;
+            return;
+        }
+        cpu_relax();
+    }
+    if (limit > WAIT_SPIN_MIN)
+        wait_spin_limit = limit / 2;
+    atomic_wait_park(obj, old);
+}
+
+inline void atomic_notify(volatile uint32_t* obj, int count)
+{
+    // Полный барьер упорядочивает загрузку счётчика после записи нового значения
+    // при любом её порядке (на x86-64 release-запись и atomic_load — простые mov):
+    // либо ожидающий увидит новое значение в futex, либо мы увидим его в счётчике
+    atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (atomic_load(&wait_bucket(obj)->waiters) != 0)
+        futex(obj, FUTEX_WAKE_PRIVATE, count);
+}
+
+inline void atomic_notify_one(volatile uint32_t* obj)
+{
+    atomic_notify(obj, 1);
+}
+
+inline void atomic_notify_all(volatile uint32_t* obj)
+{
+    atomic_notify(obj, INT32_MAX);
+}
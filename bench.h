@@ -0,0 +1,401 @@
+#pragma once
+
+#include "stdatomic_asm.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+// Количество потоков и число итераций для каждого потока
+#define NUM_THREADS 2
+#define ITERATIONS 1'000'000
+
+#if defined(__x86_64)
+inline uint64_t rdtscp()
+{
+    uint32_t lo, hi;
+    asm volatile("rdtscp" : "=a"(lo), "=d"(hi)::"rcx"); // RDTSCP
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+#endif
+
+#if defined(__riscv)
+inline uint64_t rdtscp()
+{
+    uint64_t time;
+    asm volatile("csrr %0, time" : "=r"(time)); // Читаем CSR time
+    return time;
+}
+#endif
+
+// Разделяемая атомарная переменная в собственной кэш-линии, чтобы соседние
+// данные не делили с ней линию (false sharing)
+template <class T>
+struct alignas(CACHE_LINE_SIZE) PaddedAtomic {
+    volatile T value;
+};
+
+// Число тактов rdtscp в наносекунде: на x86-64 это частота TSC, на RISC-V —
+// частота CSR time (24 МГц на X60, около 42 нс на такт). Калибровка по
+// CLOCK_MONOTONIC занимает 50 мс и выполняется один раз за запуск
+inline double ticks_per_ns()
+{
+    static const double value = [] {
+        struct timespec delay = {0, 50'000'000};
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        uint64_t c0 = rdtscp();
+        nanosleep(&delay, nullptr);
+        uint64_t c1 = rdtscp();
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double ns = (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+        return (c1 - c0) / ns;
+    }();
+    return value;
+}
+
+// Пояснение к таблицам задержек: единицы и разрешение счётчика
+inline void bench_print_latency_units()
+{
+    printf("Задержки указаны в нс, один такт счётчика rdtscp — %.2f нс\n", 1 / ticks_per_ns());
+}
+
+// Показания часов clock в наносекундах
+inline uint64_t bench_clock_ns(clockid_t clock = CLOCK_MONOTONIC)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+// Значение аргумента командной строки вида --name=value или def, если его нет
+inline const char* bench_arg(int argc, char** argv, const char* name, const char* def)
+{
+    size_t len = strlen(name);
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (arg[0] == '-' && arg[1] == '-' && strncmp(arg + 2, name, len) == 0 && arg[2 + len] == '=')
+            return arg + 3 + len;
+    }
+    return def;
+}
+
+inline uint64_t bench_arg_u64(int argc, char** argv, const char* name, uint64_t def)
+{
+    const char* value = bench_arg(argc, argv, name, nullptr);
+    return value ? strtoull(value, nullptr, 0) : def;
+}
+
+inline double bench_arg_double(int argc, char** argv, const char* name, double def)
+{
+    const char* value = bench_arg(argc, argv, name, nullptr);
+    return value ? strtod(value, nullptr) : def;
+}
+
+// Разбивает список вида a,b,c на элементы; пустые элементы пропускаются
+inline std::vector<std::string> bench_split(const char* list)
+{
+    std::vector<std::string> items;
+    std::string spec(list);
+    size_t pos = 0;
+    while (pos < spec.size()) {
+        size_t end = spec.find(',', pos);
+        if (end == std::string::npos)
+            end = spec.size();
+        if (end > pos)
+            items.push_back(spec.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    return items;
+}
+
+// Быстрый детерминированный генератор псевдослучайных чисел (xorshift64*)
+struct Rng {
+    uint64_t state;
+
+    explicit Rng(uint64_t seed) : state(seed * 0x9e3779b97f4a7c15ull + 1)
+    {
+    }
+
+    uint64_t next()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545f4914f6cdd1dull;
+    }
+
+    // Равномерное число из [0, 1)
+    double next_double()
+    {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
+
+// Гистограмма задержек: логарифмические корзины по 16 подкорзин,
+// относительная погрешность перцентилей не больше 1/16
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKETS = 16;
+    static const int BUCKETS = 61 * SUB_BUCKETS;
+
+    LatencyHistogram()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        memset(buckets_, 0, sizeof(buckets_));
+        count_ = 0;
+        sum_ = 0;
+        max_ = 0;
+    }
+
+    void record(uint64_t value)
+    {
+        buckets_[index(value)]++;
+        count_++;
+        sum_ += value;
+        if (value > max_)
+            max_ = value;
+    }
+
+    void merge(const LatencyHistogram& other)
+    {
+        for (int i = 0; i < BUCKETS; i++)
+            buckets_[i] += other.buckets_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        if (other.max_ > max_)
+            max_ = other.max_;
+    }
+
+    uint64_t count() const
+    {
+        return count_;
+    }
+
+    uint64_t max() const
+    {
+        return max_;
+    }
+
+    double mean() const
+    {
+        return count_ ? static_cast<double>(sum_) / count_ : 0.0;
+    }
+
+    // Нижняя граница корзины, в которую попадает перцентиль p из [0, 1]
+    uint64_t percentile(double p) const
+    {
+        if (count_ == 0)
+            return 0;
+        uint64_t rank = static_cast<uint64_t>(p * count_);
+        if (rank >= count_)
+            rank = count_ - 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += buckets_[i];
+            if (seen > rank)
+                return lower_bound(i);
+        }
+        return max_;
+    }
+
+private:
+    static int index(uint64_t value)
+    {
+        if (value < SUB_BUCKETS)
+            return static_cast<int>(value);
+        int msb = 63 - __builtin_clzll(value);
+        int group = msb - 3;
+        return group * SUB_BUCKETS + static_cast<int>((value >> (group - 1)) & (SUB_BUCKETS - 1));
+    }
+
+    static uint64_t lower_bound(int index)
+    {
+        int group = index / SUB_BUCKETS;
+        uint64_t sub = index % SUB_BUCKETS;
+        if (group == 0)
+            return sub;
+        return (SUB_BUCKETS + sub) << (group - 1);
+    }
+
+    uint64_t buckets_[BUCKETS];
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t max_;
+};
+
+// Запускает func(id) в num_threads потоках и дожидается их завершения
+template <class Func>
+void run_threads(unsigned num_threads, Func func)
+{
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < num_threads; i++) {
+        threads.emplace_back(func, i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+// Счётчик прогресса текущего потока; задаётся только при включённом сэмплировании
+inline thread_local volatile uint64_t* bench_progress = nullptr;
+
+// Сообщает, сколько операций поток уже выполнил (relaxed-запись в свою кэш-линию)
+inline void bench_report_progress(uint64_t done)
+{
+    if (bench_progress)
+        atomic_store_explicit(bench_progress, done, __ATOMIC_RELAXED);
+}
+
+// Поток-наблюдатель, который каждые interval_ms миллисекунд снимает счётчики
+// прогресса всех потоков. По снимкам строится временной ряд ops/s по потокам,
+// в котором видны троттлинг и вытеснение потоков планировщиком
+class ThroughputSampler {
+public:
+    ThroughputSampler(unsigned num_threads, unsigned interval_ms)
+        : counters_(num_threads), interval_ms_(interval_ms), stop_(0)
+    {
+    }
+
+    ~ThroughputSampler()
+    {
+        stop();
+    }
+
+    volatile uint64_t* counter(unsigned id)
+    {
+        return &counters_[id].value;
+    }
+
+    void start()
+    {
+        take_sample();
+        monitor_ = std::thread(&ThroughputSampler::run, this);
+    }
+
+    void stop()
+    {
+        if (!monitor_.joinable())
+            return;
+        atomic_store_explicit(&stop_, 1, __ATOMIC_RELAXED);
+        monitor_.join();
+        take_sample();
+    }
+
+    // Печатает временной ряд; интервалы, где хоть один поток не продвинулся, помечаются
+    void print() const
+    {
+        printf("Временной ряд с интервалом %u мс, ops/s по потокам:\n", interval_ms_);
+        printf("%10s", "t ms");
+        for (size_t id = 0; id < counters_.size(); id++)
+            printf(" %10s%-2zu", "thread ", id);
+        printf(" %14s\n", "total");
+
+        unsigned stalled = 0, measured = 0;
+        double min_total = 0, max_total = 0;
+        for (size_t i = 1; i < samples_.size(); i++) {
+            const Sample& prev = samples_[i - 1];
+            const Sample& cur = samples_[i];
+            double seconds = (cur.time_ns - prev.time_ns) / 1e9;
+            if (seconds <= 0)
+                continue;
+            printf("%10.1f", (cur.time_ns - samples_[0].time_ns) / 1e6);
+            double total = 0;
+            bool partial = false;
+            std::vector<size_t> idle;
+            for (size_t id = 0; id < counters_.size(); id++) {
+                uint64_t delta = cur.values[id] - prev.values[id];
+                uint64_t last = samples_.back().values[id];
+                // Поток, который уже закончил работу, простоем не считается, а интервал,
+                // в котором он закончил, не учитывается в минимуме и максимуме
+                if (delta == 0 && prev.values[id] != last)
+                    idle.push_back(id);
+                if (delta != 0 && cur.values[id] == last)
+                    partial = true;
+                printf(" %12.0f", delta / seconds);
+                total += delta / seconds;
+            }
+            printf(" %14.0f", total);
+            if (!idle.empty()) {
+                stalled++;
+                printf("  нет прогресса:");
+                for (size_t id : idle)
+                    printf(" %zu", id);
+            }
+            printf("\n");
+            if (partial)
+                continue;
+            if (measured++ == 0 || total < min_total)
+                min_total = total;
+            if (total > max_total)
+                max_total = total;
+        }
+        printf("Интервалов: %zu, без прогресса хотя бы одного потока: %u, суммарно ops/s от %.0f до %.0f\n",
+               samples_.size() ? samples_.size() - 1 : 0,
+               stalled,
+               min_total,
+               max_total);
+    }
+
+private:
+    struct Sample {
+        uint64_t time_ns;
+        std::vector<uint64_t> values;
+    };
+
+    void take_sample()
+    {
+        Sample sample;
+        sample.time_ns = bench_clock_ns();
+        for (auto& c : counters_)
+            sample.values.push_back(atomic_load_explicit(&c.value, __ATOMIC_RELAXED));
+        samples_.push_back(sample);
+    }
+
+    // Просыпается по абсолютному времени, чтобы интервалы не накапливали сдвиг.
+    // Если наблюдатель проспал несколько сроков, пропущенные сроки не догоняются:
+    // иначе снимки пошли бы подряд и дали бы почти пустые интервалы без прогресса
+    void run()
+    {
+        uint64_t interval_ns = static_cast<uint64_t>(interval_ms_) * 1'000'000;
+        uint64_t next = bench_clock_ns();
+        while (atomic_load_explicit(&stop_, __ATOMIC_RELAXED) == 0) {
+            next += interval_ns;
+            uint64_t now = bench_clock_ns();
+            if (next <= now)
+                next += (now - next) / interval_ns * interval_ns + interval_ns;
+            struct timespec deadline = {static_cast<time_t>(next / 1'000'000'000),
+                                        static_cast<long>(next % 1'000'000'000)};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+            // Последний снимок делает stop(), уже после завершения всех потоков
+            if (atomic_load_explicit(&stop_, __ATOMIC_RELAXED) != 0)
+                break;
+            take_sample();
+        }
+    }
+
+    std::vector<PaddedAtomic<uint64_t>> counters_;
+    std::vector<Sample> samples_;
+    unsigned interval_ms_;
+    volatile uint32_t stop_;
+    std::thread monitor_;
+};
+
+// Режимы, которые выбираются первым аргументом командной строки
+int bench_workload(int argc, char** argv);
+int bench_minmax(int argc, char** argv);
+int bench_wait(int argc, char** argv);
+int bench_combining(int argc, char** argv);
+int bench_readmostly(int argc, char** argv);
+int bench_timeline(int argc, char** argv);
+int bench_lockfree(int argc, char** argv);
+int bench_openloop(int argc, char** argv);
+int bench_litmus(int argc, char** argv);
@@ -0,0 +1,100 @@
+#include "bench.h"
+#include "flat_combining.h"
+#include "stdatomic_asm.h"
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+
+// Разделяемый счётчик под нагрузкой от 1 до N потоков тремя способами:
+//   amo   atomic_fetch_add прямо на общей переменной
+//   cas   CAS-цикл инкремента на общей переменной
+//   fc    flat combining: запросы выполняет один поток-комбайнер
+// Точка пересечения — первое число потоков, при котором fc быстрее amo.
+//
+// Параметры:
+//   --threads=N   максимальное число потоков
+//   --iters=N     число операций на поток
+
+enum CounterImpl { COUNTER_AMO, COUNTER_CAS, COUNTER_FC, COUNTER_IMPL_COUNT };
+
+static PaddedAtomic<uint64_t> g_counter;
+
+static uint64_t counter_add(uint64_t& counter, uint64_t arg)
+{
+    uint64_t old = counter;
+    counter += arg;
+    return old;
+}
+
+static void counter_thread(CounterImpl impl, unsigned id, uint64_t iters, FlatCombiner<uint64_t>* combiner)
+{
+    for (uint64_t i = 0; i < iters; i++) {
+        switch (impl) {
+        case COUNTER_AMO:
+            atomic_fetch_add(&g_counter.value, 1);
+            break;
+        case COUNTER_CAS: {
+            uint64_t expected = atomic_load_explicit(&g_counter.value, __ATOMIC_RELAXED);
+            while (!atomic_cas_bool(&g_counter.value, &expected, expected + 1)) {
+            }
+            break;
+        }
+        default:
+            combiner->apply(id, counter_add, 1);
+            break;
+        }
+    }
+}
+
+// Пропускная способность в миллионах операций в секунду;
+// *ok сбрасывается, если итоговый счётчик не совпал с числом операций
+static double counter_run(CounterImpl impl, unsigned num_threads, uint64_t iters, double* batch, bool* ok)
+{
+    FlatCombiner<uint64_t> combiner(num_threads);
+    g_counter.value = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    run_threads(num_threads, [&](unsigned id) { counter_thread(impl, id, iters, &combiner); });
+    auto end = std::chrono::high_resolution_clock::now();
+
+    uint64_t result = impl == COUNTER_FC ? combiner.object() : g_counter.value;
+    if (result != num_threads * iters) {
+        fprintf(stderr,
+                "Ошибка: счётчик %llu, ожидалось %llu\n",
+                (unsigned long long)result,
+                (unsigned long long)(num_threads * iters));
+        *ok = false;
+    }
+    if (impl == COUNTER_FC)
+        *batch = combiner.batches() ? static_cast<double>(combiner.combined()) / combiner.batches() : 0;
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return num_threads * iters / seconds / 1e6;
+}
+
+int bench_combining(int argc, char** argv)
+{
+    unsigned max_threads = bench_arg_u64(argc, argv, "threads", NUM_THREADS);
+    uint64_t iters = bench_arg_u64(argc, argv, "iters", ITERATIONS);
+
+    printf("Flat combining против прямых атомарных операций: до %u потоков, %llu операций на поток\n",
+           max_threads,
+           (unsigned long long)iters);
+    printf("%8s %12s %12s %12s %10s\n", "threads", "amo Mops/s", "cas Mops/s", "fc Mops/s", "fc batch");
+    unsigned crossover = 0;
+    bool ok = true;
+    for (unsigned threads = 1; threads <= max_threads; threads++) {
+        double batch = 0;
+        double amo = counter_run(COUNTER_AMO, threads, iters, &batch, &ok);
+        double cas = counter_run(COUNTER_CAS, threads, iters, &batch, &ok);
+        double fc = counter_run(COUNTER_FC, threads, iters, &batch, &ok);
+        printf("%8u %12.2f %12.2f %12.2f %10.2f\n", threads, amo, cas, fc, batch);
+        if (crossover == 0 && fc > amo)
+            crossover = threads;
+    }
+    if (crossover)
+        printf("Flat combining обгоняет AMO начиная с %u потоков\n", crossover);
+    else
+        printf("Flat combining не обогнал AMO ни при каком числе потоков\n");
+    return ok ? 0 : 1;
+}
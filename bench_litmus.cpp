@@ -0,0 +1,455 @@
+#include "atomic_wait.h"
+#include "bench.h"
+#include "stdatomic_asm.h"
+#include <map>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Лакмусовые тесты модели памяти: классические шаблоны MP, SB, LB, IRIW и 2+2W
+// для каждого варианта упорядочивания из stdatomic_asm.h:
+//   - загрузки и записи relaxed, acquire/release и seq_cst;
+//   - relaxed-доступы с барьерами: release перед записью и acquire перед
+//     загрузкой (fence-rel/acq), acq_rel, seq_cst и fence.tso. На RISC-V
+//     барьеры acq_rel и seq_cst дают одну и ту же инструкцию fence rw,rw,
+//     на x86-64 они различаются (mfence только у seq_cst);
+//   - записи через atomic_exchange и загрузки через atomic_fetch_add с нулём
+//     с порядками relaxed, release/acquire, acq_rel и seq_cst;
+//   - то же через atomic_cas_bool_explicit: запись — CAS-цикл, загрузка — CAS
+//     0 -> 0, который при ненулевом значении превращается в загрузку с
+//     порядком неудачи.
+// Каждый прогон идёт на своих переменных:
+// потоки встречаются на барьере прогона и выжидают случайную паузу, чтобы
+// перебрать как можно больше относительных сдвигов по времени.
+//
+// Для каждого сочетания печатается гистограмма исходов. Слабый исход помечается
+// как запрещённый, если его исключает модель C11 для использованных порядков
+// (для fence.tso — модель RVWMO, в C11 такого барьера нет). Если запрещённый
+// исход встретился хотя бы раз, режим завершается с ненулевым кодом.
+// Разрешённый слабый исход может и не появляться: железо бывает строже модели.
+//
+// Параметры:
+//   --tests=MP,SB,LB,IRIW,2+2W   шаблоны
+//   --orders=all                 варианты упорядочивания через запятую или all
+//   --iters=N                    число прогонов каждого сочетания
+//   --jitter=64                  максимальная случайная пауза перед прогоном, итераций cpu_relax
+
+// Число прогонов, после которых исходы подсчитываются и переменные обнуляются
+#define LITMUS_BATCH 1024
+
+enum LitmusFence { LT_FENCE_NONE, LT_FENCE_REL_ACQ, LT_FENCE_ACQ_REL, LT_FENCE_SEQ_CST, LT_FENCE_TSO };
+
+// Чем выполняются записи и загрузки
+enum LitmusAccess { LT_PLAIN, LT_AMO, LT_CAS };
+
+struct LitmusOrder {
+    const char* name;
+    int store;
+    int load;
+    LitmusFence fence;
+    LitmusAccess access;
+};
+
+#define LT_ORDER_COUNT 15
+
+static const LitmusOrder litmus_orders[LT_ORDER_COUNT] = {
+        {"relaxed", __ATOMIC_RELAXED, __ATOMIC_RELAXED, LT_FENCE_NONE, LT_PLAIN},
+        {"rel/acq", __ATOMIC_RELEASE, __ATOMIC_ACQUIRE, LT_FENCE_NONE, LT_PLAIN},
+        {"seq_cst", __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST, LT_FENCE_NONE, LT_PLAIN},
+        {"fence-rel/acq", __ATOMIC_RELAXED, __ATOMIC_RELAXED, LT_FENCE_REL_ACQ, LT_PLAIN},
+        {"fence-acq_rel", __ATOMIC_RELAXED, __ATOMIC_RELAXED, LT_FENCE_ACQ_REL, LT_PLAIN},
+        {"fence-seq_cst", __ATOMIC_RELAXED, __ATOMIC_RELAXED, LT_FENCE_SEQ_CST, LT_PLAIN},
+        {"fence.tso", __ATOMIC_RELAXED, __ATOMIC_RELAXED, LT_FENCE_TSO, LT_PLAIN},
+        {"amo-relaxed", __ATOMIC_RELAXED, __ATOMIC_RELAXED, LT_FENCE_NONE, LT_AMO},
+        {"amo-rel/acq", __ATOMIC_RELEASE, __ATOMIC_ACQUIRE, LT_FENCE_NONE, LT_AMO},
+        {"amo-acq_rel", __ATOMIC_ACQ_REL, __ATOMIC_ACQ_REL, LT_FENCE_NONE, LT_AMO},
+        {"amo-seq_cst", __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST, LT_FENCE_NONE, LT_AMO},
+        {"cas-relaxed", __ATOMIC_RELAXED, __ATOMIC_RELAXED, LT_FENCE_NONE, LT_CAS},
+        {"cas-rel/acq", __ATOMIC_RELEASE, __ATOMIC_ACQUIRE, LT_FENCE_NONE, LT_CAS},
+        {"cas-acq_rel", __ATOMIC_ACQ_REL, __ATOMIC_ACQ_REL, LT_FENCE_NONE, LT_CAS},
+        {"cas-seq_cst", __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST, LT_FENCE_NONE, LT_CAS},
+};
+
+// Барьер многократного использования: последний пришедший сдвигает поколение
+struct alignas(CACHE_LINE_SIZE) LitmusBarrier {
+    volatile uint32_t arrived;
+    volatile uint32_t generation;
+};
+
+static void litmus_barrier_wait(LitmusBarrier* b, unsigned num_threads)
+{
+    uint32_t generation = atomic_load_explicit(&b->generation, __ATOMIC_ACQUIRE);
+    if (atomic_fetch_add(&b->arrived, 1) + 1 == num_threads) {
+        atomic_store_explicit(&b->arrived, 0, __ATOMIC_RELAXED);
+        atomic_store(&b->generation, generation + 1);
+        atomic_notify_all(&b->generation);
+    } else {
+        atomic_wait(&b->generation, generation);
+    }
+}
+
+// Переменные одного прогона, каждая в своей кэш-линии
+struct LitmusInstance {
+    alignas(CACHE_LINE_SIZE) volatile uint32_t x;
+    alignas(CACHE_LINE_SIZE) volatile uint32_t y;
+    LitmusBarrier start;
+    alignas(CACHE_LINE_SIZE) uint32_t r[4];
+};
+
+// Порядок неудачного CAS: C11 не допускает для него release и acq_rel
+static inline int litmus_failure_order(int order)
+{
+    if (order == __ATOMIC_ACQ_REL)
+        return __ATOMIC_ACQUIRE;
+    return order == __ATOMIC_RELEASE ? __ATOMIC_RELAXED : order;
+}
+
+static void litmus_store(volatile uint32_t* obj, uint32_t value, const LitmusOrder& order)
+{
+    switch (order.access) {
+    case LT_AMO:
+        atomic_exchange_explicit(obj, value, order.store);
+        break;
+    case LT_CAS: {
+        uint32_t expected = atomic_load_explicit(obj, __ATOMIC_RELAXED);
+        while (!atomic_cas_bool_explicit(obj, &expected, value, order.store, litmus_failure_order(order.store))) {
+        }
+        break;
+    }
+    default:
+        atomic_store_explicit(obj, value, order.store);
+        break;
+    }
+}
+
+static uint32_t litmus_load(volatile uint32_t* obj, const LitmusOrder& order)
+{
+    switch (order.access) {
+    case LT_AMO:
+        return atomic_fetch_add_explicit(obj, 0, order.load);
+    case LT_CAS: {
+        uint32_t expected = 0;
+        atomic_cas_bool_explicit(obj, &expected, 0, order.load, litmus_failure_order(order.load));
+        return expected;
+    }
+    default:
+        return atomic_load_explicit(obj, order.load);
+    }
+}
+
+// Барьер между двумя доступами потока; store_next — следующий доступ является записью.
+// Вариант fence-rel/acq ставит release перед записью и acquire перед загрузкой
+static void litmus_fence(const LitmusOrder& order, bool store_next)
+{
+    switch (order.fence) {
+    case LT_FENCE_REL_ACQ:
+        atomic_thread_fence(store_next ? __ATOMIC_RELEASE : __ATOMIC_ACQUIRE);
+        break;
+    case LT_FENCE_ACQ_REL:
+        atomic_thread_fence(__ATOMIC_ACQ_REL);
+        break;
+    case LT_FENCE_SEQ_CST:
+        atomic_thread_fence(__ATOMIC_SEQ_CST);
+        break;
+    case LT_FENCE_TSO:
+        atomic_thread_fence_tso();
+        break;
+    default:
+        break;
+    }
+}
+
+// Message passing: увидев флаг y, читатель обязан увидеть и данные x
+static void litmus_mp(unsigned role, LitmusInstance* in, const LitmusOrder& order)
+{
+    if (role == 0) {
+        litmus_store(&in->x, 1, order);
+        litmus_fence(order, true);
+        litmus_store(&in->y, 1, order);
+    } else {
+        in->r[0] = litmus_load(&in->y, order);
+        litmus_fence(order, false);
+        in->r[1] = litmus_load(&in->x, order);
+    }
+}
+
+// Store buffering: оба потока не видят чужую запись, только если запись
+// переставлена после следующей за ней загрузки
+static void litmus_sb(unsigned role, LitmusInstance* in, const LitmusOrder& order)
+{
+    volatile uint32_t* mine = role == 0 ? &in->x : &in->y;
+    volatile uint32_t* other = role == 0 ? &in->y : &in->x;
+    litmus_store(mine, 1, order);
+    litmus_fence(order, false);
+    in->r[role] = litmus_load(other, order);
+}
+
+// Load buffering: каждая загрузка видит запись, сделанную в другом потоке после
+// его собственной загрузки
+static void litmus_lb(unsigned role, LitmusInstance* in, const LitmusOrder& order)
+{
+    volatile uint32_t* mine = role == 0 ? &in->y : &in->x;
+    volatile uint32_t* other = role == 0 ? &in->x : &in->y;
+    in->r[role] = litmus_load(other, order);
+    litmus_fence(order, true);
+    litmus_store(mine, 1, order);
+}
+
+// Independent reads of independent writes: два читателя видят независимые
+// записи в разном порядке
+static void litmus_iriw(unsigned role, LitmusInstance* in, const LitmusOrder& order)
+{
+    switch (role) {
+    case 0:
+        litmus_store(&in->x, 1, order);
+        break;
+    case 1:
+        litmus_store(&in->y, 1, order);
+        break;
+    case 2:
+        in->r[0] = litmus_load(&in->x, order);
+        litmus_fence(order, false);
+        in->r[1] = litmus_load(&in->y, order);
+        break;
+    default:
+        in->r[2] = litmus_load(&in->y, order);
+        litmus_fence(order, false);
+        in->r[3] = litmus_load(&in->x, order);
+        break;
+    }
+}
+
+// 2+2W: первая запись каждого потока оказывается последней в своей переменной
+static void litmus_2_2w(unsigned role, LitmusInstance* in, const LitmusOrder& order)
+{
+    volatile uint32_t* first = role == 0 ? &in->x : &in->y;
+    volatile uint32_t* second = role == 0 ? &in->y : &in->x;
+    litmus_store(first, 1, order);
+    litmus_fence(order, true);
+    litmus_store(second, 2, order);
+}
+
+// Исход упаковывается по два бита на наблюдаемое значение
+static uint32_t litmus_pack(const uint32_t* values, unsigned count)
+{
+    uint32_t outcome = 0;
+    for (unsigned i = 0; i < count; i++)
+        outcome |= (values[i] & 3) << (2 * i);
+    return outcome;
+}
+
+static uint32_t litmus_outcome_regs2(const LitmusInstance& in)
+{
+    return litmus_pack(in.r, 2);
+}
+
+static uint32_t litmus_outcome_regs4(const LitmusInstance& in)
+{
+    return litmus_pack(in.r, 4);
+}
+
+static uint32_t litmus_outcome_final(const LitmusInstance& in)
+{
+    uint32_t values[2] = {in.x, in.y};
+    return litmus_pack(values, 2);
+}
+
+struct LitmusTest {
+    const char* name;
+    unsigned threads;
+    void (*thread)(unsigned role, LitmusInstance* in, const LitmusOrder& order);
+    uint32_t (*outcome)(const LitmusInstance& in);
+    const char* labels[4];
+    unsigned values;
+    uint32_t weak;
+    // Запрещён ли слабый исход для каждого варианта из litmus_orders
+    bool forbidden[LT_ORDER_COUNT];
+};
+
+// Запрещённость слабого исхода по вариантам в порядке litmus_orders:
+//   relaxed, rel/acq, seq_cst,
+//   fence-rel/acq, fence-acq_rel, fence-seq_cst, fence.tso,
+//   amo-relaxed, amo-rel/acq, amo-acq_rel, amo-seq_cst,
+//   cas-relaxed, cas-rel/acq, cas-acq_rel, cas-seq_cst
+// SB, IRIW и 2+2W c acq_rel-AMO и CAS запрещены: чтение в них тоже RMW, и
+// записи другого потока синхронизируются с ним через чтение-модификацию.
+// IRIW и 2+2W с fence.tso запрещены в RVWMO: модель атомарна по записи, а
+// барьер упорядочивает чтения между собой и записи между собой.
+// IRIW с amo-rel/acq не проверяется: его разрешённость в C11 зависит от
+// порядка модификации, который тест не наблюдает.
+static const LitmusTest litmus_tests[] = {
+        {"MP",
+         2,
+         litmus_mp,
+         litmus_outcome_regs2,
+         {"r0", "r1"},
+         2,
+         1 | 0 << 2,
+         {0, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1}},
+        {"SB",
+         2,
+         litmus_sb,
+         litmus_outcome_regs2,
+         {"r0", "r1"},
+         2,
+         0 | 0 << 2,
+         {0, 0, 1, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 1, 1}},
+        {"LB",
+         2,
+         litmus_lb,
+         litmus_outcome_regs2,
+         {"r0", "r1"},
+         2,
+         1 | 1 << 2,
+         {0, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1}},
+        {"IRIW",
+         4,
+         litmus_iriw,
+         litmus_outcome_regs4,
+         {"r0", "r1", "r2", "r3"},
+         4,
+         1 | 0 << 2 | 1 << 4 | 0 << 6,
+         {0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1}},
+        {"2+2W",
+         2,
+         litmus_2_2w,
+         litmus_outcome_final,
+         {"x", "y"},
+         2,
+         1 | 1 << 2,
+         {0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1}},
+};
+
+struct LitmusResult {
+    std::map<uint32_t, uint64_t> outcomes;
+    uint64_t weak;
+};
+
+static LitmusResult litmus_run(const LitmusTest& test, const LitmusOrder& order, uint64_t iters, unsigned jitter)
+{
+    std::vector<LitmusInstance> batch(LITMUS_BATCH);
+    LitmusBarrier batch_barrier = {};
+    LitmusResult result = {};
+
+    run_threads(test.threads, [&](unsigned id) {
+        Rng rng(id + 1);
+        for (uint64_t done = 0; done < iters; done += LITMUS_BATCH) {
+            uint64_t count = iters - done < LITMUS_BATCH ? iters - done : LITMUS_BATCH;
+            for (uint64_t i = 0; i < count; i++) {
+                LitmusInstance* in = &batch[i];
+                litmus_barrier_wait(&in->start, test.threads);
+                for (uint64_t spins = rng.next() % (jitter + 1); spins > 0; spins--)
+                    cpu_relax();
+                test.thread(id, in, order);
+            }
+
+            // Подсчёт и обнуление, пока остальные потоки стоят на барьере
+            litmus_barrier_wait(&batch_barrier, test.threads);
+            if (id == 0) {
+                for (uint64_t i = 0; i < count; i++) {
+                    LitmusInstance& in = batch[i];
+                    result.outcomes[test.outcome(in)]++;
+                    in.x = 0;
+                    in.y = 0;
+                    for (uint32_t& r : in.r)
+                        r = 0;
+                }
+            }
+            litmus_barrier_wait(&batch_barrier, test.threads);
+        }
+    });
+
+    auto weak = result.outcomes.find(test.weak);
+    result.weak = weak == result.outcomes.end() ? 0 : weak->second;
+    return result;
+}
+
+static void litmus_print(const LitmusTest& test, const LitmusOrder& order, const LitmusResult& result, bool forbidden)
+{
+    printf("%s, %s:\n", test.name, order.name);
+    for (const auto& [outcome, count] : result.outcomes) {
+        std::string text;
+        for (unsigned i = 0; i < test.values; i++) {
+            char value[32];
+            snprintf(value, sizeof(value), "%s%s=%u", i ? " " : "", test.labels[i], outcome >> (2 * i) & 3);
+            text += value;
+        }
+        const char* mark = "";
+        if (outcome == test.weak)
+            mark = forbidden ? "  слабый, ЗАПРЕЩЁН" : "  слабый, разрешён";
+        printf("    %-24s %12llu%s\n", text.c_str(), (unsigned long long)count, mark);
+    }
+}
+
+// Список имён через запятую или all; пустой результат, если встретилось неизвестное имя
+template <class Item, size_t N>
+static std::vector<const Item*> litmus_select(const char* list, const Item (&items)[N])
+{
+    std::vector<const Item*> selected;
+    if (strcmp(list, "all") == 0) {
+        for (const Item& item : items)
+            selected.push_back(&item);
+        return selected;
+    }
+    for (const std::string& name : bench_split(list)) {
+        size_t i = 0;
+        while (i < N && name != items[i].name)
+            i++;
+        if (i == N) {
+            fprintf(stderr, "Неизвестное имя: %s\n", name.c_str());
+            return {};
+        }
+        selected.push_back(&items[i]);
+    }
+    return selected;
+}
+
+int bench_litmus(int argc, char** argv)
+{
+    auto tests = litmus_select(bench_arg(argc, argv, "tests", "all"), litmus_tests);
+    auto orders = litmus_select(bench_arg(argc, argv, "orders", "all"), litmus_orders);
+    uint64_t iters = bench_arg_u64(argc, argv, "iters", ITERATIONS);
+    unsigned jitter = bench_arg_u64(argc, argv, "jitter", 64);
+    if (tests.empty() || orders.empty())
+        return 1;
+
+    printf("Лакмусовые тесты модели памяти: %llu прогонов на сочетание, пауза до %u итераций cpu_relax\n",
+           (unsigned long long)iters,
+           jitter);
+
+    // Сводка: сколько раз встретился слабый исход, '!' — запрещённый
+    std::vector<std::vector<std::string>> summary(orders.size());
+    bool failed = false;
+    for (const LitmusTest* test : tests) {
+        for (size_t o = 0; o < orders.size(); o++) {
+            bool forbidden = test->forbidden[orders[o] - litmus_orders];
+            LitmusResult result = litmus_run(*test, *orders[o], iters, jitter);
+            litmus_print(*test, *orders[o], result, forbidden);
+
+            char cell[32];
+            snprintf(cell, sizeof(cell), "%llu%s", (unsigned long long)result.weak, forbidden ? "!" : " ");
+            summary[o].push_back(cell);
+            if (forbidden && result.weak) {
+                fprintf(stderr,
+                        "Ошибка: %s, %s: запрещённый исход встретился %llu раз\n",
+                        test->name,
+                        orders[o]->name,
+                        (unsigned long long)result.weak);
+                failed = true;
+            }
+        }
+    }
+
+    printf("\nСлабые исходы ('!' — запрещены для этого варианта):\n%-14s", "order");
+    for (const LitmusTest* test : tests)
+        printf(" %10s ", test->name);
+    printf("\n");
+    for (size_t o = 0; o < orders.size(); o++) {
+        printf("%-14s", orders[o]->name);
+        for (const std::string& cell : summary[o])
+            printf(" %11s", cell.c_str());
+        printf("\n");
+    }
+    return failed ? 1 : 0;
+}
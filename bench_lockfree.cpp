@@ -0,0 +1,186 @@
+#include "bench.h"
+#include "lockfree.h"
+#include "stdatomic_asm.h"
+#include <algorithm>
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+// Стек Трайбера и очередь Майкла-Скотта: каждый поток чередует вставку и
+// извлечение, так что структура всё время остаётся около начального размера.
+// Здесь CAS работает над указателями, которые читаются из только что
+// полученных узлов: на RISC-V это цикл LR/SC в __atomic_cmpxchg_asm,
+// на x86-64 — lock cmpxchg.
+//
+// Параметры:
+//   --threads=N   максимальное число потоков, перебираются 1..N
+//   --iters=N     число пар вставка/извлечение на поток
+//   --prefill=N   число элементов в структуре перед замером
+//
+// Значение элемента — номер вставившего потока (у начальных элементов номер
+// равен числу потоков) в старших битах и порядковый номер вставки в младших.
+// Каждый поток дописывает извлечённые значения в свой заранее выделенный
+// массив. После замера массивы сливаются и сортируются, и каждое вставленное
+// значение должно встретиться ровно один раз. Иначе режим возвращает 1.
+
+enum LockFreeKind { LF_STACK, LF_QUEUE, LF_KIND_COUNT };
+
+static const char* const lf_kind_names[LF_KIND_COUNT] = {"stack", "queue"};
+
+#define LF_INDEX_BITS 40
+
+struct alignas(CACHE_LINE_SIZE) LockFreeStats {
+    LatencyHistogram push;
+    LatencyHistogram pop;
+    uint64_t empty;
+    // Извлечённые этим потоком значения: не больше iters, пишутся подряд
+    std::vector<uint64_t> popped;
+    uint64_t popped_count;
+};
+
+// Единый интерфейс вставки и извлечения для обоих контейнеров
+static void lockfree_op_push(TreiberStack<uint64_t>& c, unsigned id, uint64_t value)
+{
+    c.push(id, value);
+}
+
+static void lockfree_op_push(MichaelScottQueue<uint64_t>& c, unsigned id, uint64_t value)
+{
+    c.enqueue(id, value);
+}
+
+static bool lockfree_op_pop(TreiberStack<uint64_t>& c, unsigned id, uint64_t* value)
+{
+    return c.pop(id, value);
+}
+
+static bool lockfree_op_pop(MichaelScottQueue<uint64_t>& c, unsigned id, uint64_t* value)
+{
+    return c.dequeue(id, value);
+}
+
+template <class Container>
+static void lockfree_thread(Container* c, unsigned id, uint64_t iters, LockFreeStats* stats)
+{
+    for (uint64_t i = 0; i < iters; i++) {
+        uint64_t value = (static_cast<uint64_t>(id) << LF_INDEX_BITS) | i;
+        uint64_t start = rdtscp();
+        lockfree_op_push(*c, id, value);
+        uint64_t mid = rdtscp();
+        bool popped = lockfree_op_pop(*c, id, &value);
+        uint64_t end = rdtscp();
+        stats->push.record(mid - start);
+        stats->pop.record(end - mid);
+        if (popped)
+            stats->popped[stats->popped_count++] = value;
+        else
+            stats->empty++;
+    }
+}
+
+// Возвращает false, если какое-то значение потерялось, извлеклось дважды
+// или не было вставлено
+template <class Container>
+static bool lockfree_run(LockFreeKind kind, unsigned num_threads, uint64_t iters, uint64_t prefill)
+{
+    Container c(num_threads);
+    for (uint64_t i = 0; i < prefill; i++)
+        lockfree_op_push(c, 0, (static_cast<uint64_t>(num_threads) << LF_INDEX_BITS) | i);
+
+    std::vector<LockFreeStats> stats(num_threads);
+    for (auto& s : stats) {
+        s.popped.resize(iters);
+        s.popped_count = 0;
+        s.empty = 0;
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    run_threads(num_threads, [&](unsigned id) { lockfree_thread(&c, id, iters, &stats[id]); });
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    // Извлечённое потоками и остаток структуры сливаются и сортируются; значения
+    // упорядочены по (источник, номер вставки), так что ожидаемый набор
+    // проходится в том же порядке
+    std::vector<uint64_t> popped;
+    uint64_t empty = 0, value;
+    LatencyHistogram push, pop;
+    for (auto& s : stats) {
+        popped.insert(popped.end(), s.popped.begin(), s.popped.begin() + s.popped_count);
+        empty += s.empty;
+        push.merge(s.push);
+        pop.merge(s.pop);
+    }
+    while (lockfree_op_pop(c, 0, &value))
+        popped.push_back(value);
+    std::sort(popped.begin(), popped.end());
+
+    uint64_t duplicates = 0, lost = 0, unexpected = 0;
+    size_t k = 0;
+    for (uint64_t source = 0; source <= num_threads; source++) {
+        uint64_t count = source == num_threads ? prefill : iters;
+        for (uint64_t i = 0; i < count; i++) {
+            uint64_t expected = (source << LF_INDEX_BITS) | i;
+            for (; k < popped.size() && popped[k] < expected; k++)
+                unexpected++;
+            if (k == popped.size() || popped[k] != expected) {
+                lost++;
+                continue;
+            }
+            for (k++; k < popped.size() && popped[k] == expected; k++)
+                duplicates++;
+        }
+    }
+    unexpected += popped.size() - k;
+    bool ok = duplicates == 0 && lost == 0 && unexpected == 0;
+    if (!ok)
+        fprintf(stderr,
+                "Ошибка: %llu значений извлечено повторно, %llu потеряно, %llu не вставлялись\n",
+                (unsigned long long)duplicates,
+                (unsigned long long)lost,
+                (unsigned long long)unexpected);
+
+    double tpns = ticks_per_ns();
+    printf("%-6s %8u %12.2f %10.1f %8.1f %8.1f %10.1f %8.1f %8.1f %8llu\n",
+           lf_kind_names[kind],
+           num_threads,
+           2 * num_threads * iters / seconds / 1e6,
+           push.mean() / tpns,
+           push.percentile(0.5) / tpns,
+           push.percentile(0.99) / tpns,
+           pop.mean() / tpns,
+           pop.percentile(0.5) / tpns,
+           pop.percentile(0.99) / tpns,
+           (unsigned long long)empty);
+    return ok;
+}
+
+int bench_lockfree(int argc, char** argv)
+{
+    unsigned max_threads = bench_arg_u64(argc, argv, "threads", NUM_THREADS);
+    uint64_t iters = bench_arg_u64(argc, argv, "iters", ITERATIONS);
+    uint64_t prefill = bench_arg_u64(argc, argv, "prefill", 1024);
+
+    printf("Lock-free стек и очередь: до %u потоков, %llu пар операций на поток, %llu элементов заранее\n",
+           max_threads,
+           (unsigned long long)iters,
+           (unsigned long long)prefill);
+    printf("%-6s %8s %12s %10s %8s %8s %10s %8s %8s %8s\n",
+           "kind",
+           "threads",
+           "Mops/s",
+           "push mean",
+           "p50",
+           "p99",
+           "pop mean",
+           "p50",
+           "p99",
+           "empty");
+    bool ok = true;
+    for (unsigned threads = 1; threads <= max_threads; threads++)
+        ok &= lockfree_run<TreiberStack<uint64_t>>(LF_STACK, threads, iters, prefill);
+    for (unsigned threads = 1; threads <= max_threads; threads++)
+        ok &= lockfree_run<MichaelScottQueue<uint64_t>>(LF_QUEUE, threads, iters, prefill);
+    bench_print_latency_units();
+    return ok ? 0 : 1;
+}
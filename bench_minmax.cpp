@@ -0,0 +1,190 @@
+#include "bench.h"
+#include "stdatomic_asm.h"
+#include <chrono>
+#include <limits>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Сравнение atomic_fetch_min/max (amomin/amomax на RISC-V) с CAS-циклом
+// atomic_fetch_min_cas/max_cas при росте числа потоков.
+// На x86-64 atomic_fetch_min/max сами реализованы CAS-циклом, поэтому там
+// обе колонки должны совпадать в пределах шума.
+// Для знаковых типов RISC-V выбирает amomin/amomax, для беззнаковых —
+// amominu/amomaxu, а для 64-битных — варианты .d; итоговое значение
+// проверяется для каждого сочетания, при ошибке режим возвращает 1.
+//
+// Параметры:
+//   --threads=N               максимальное число потоков, перебираются 1..N
+//   --iters=N                 число операций на поток
+//   --types=u32,i32,u64,i64   типы операнда
+//   --orders=seq_cst,relaxed  порядок памяти для atomic_fetch_min/max_explicit
+//
+// Шаблоны аргументов:
+//   rising  max получает растущие значения, min — убывающие: каждая операция
+//           меняет переменную (худший случай для CAS-цикла); у знаковых типов
+//           значения переходят через ноль
+//   random  случайные значения: после прогрева граница почти не меняется,
+//           и CAS-цикл выходит после первого чтения
+
+enum MinMaxOp { MM_MIN, MM_MAX };
+enum MinMaxImpl { MM_NATIVE, MM_CAS };
+
+template <class T>
+static PaddedAtomic<T> g_minmax;
+
+template <class T>
+static std::vector<T> minmax_args(unsigned id, unsigned num_threads, uint64_t iters, bool rising, MinMaxOp op)
+{
+    std::vector<T> args(iters);
+    Rng rng(id + 1);
+    // Для знаковых типов растущая последовательность начинается с отрицательных значений
+    uint64_t shift = std::numeric_limits<T>::is_signed ? iters * num_threads / 2 : 0;
+    for (uint64_t i = 0; i < iters; i++) {
+        if (!rising) {
+            args[i] = static_cast<T>(rng.next());
+            continue;
+        }
+        uint64_t step = i * num_threads + id;
+        if (op == MM_MAX)
+            args[i] = std::numeric_limits<T>::is_signed ? static_cast<T>(step - shift) : static_cast<T>(step);
+        else
+            args[i] = std::numeric_limits<T>::is_signed ? static_cast<T>(shift - step)
+                                                        : std::numeric_limits<T>::max() - static_cast<T>(step);
+    }
+    return args;
+}
+
+template <class T>
+static void minmax_thread(const std::vector<T>& args, MinMaxOp op, MinMaxImpl impl, int order)
+{
+    volatile T* obj = &g_minmax<T>.value;
+    for (T arg : args) {
+        if (op == MM_MIN) {
+            if (impl == MM_NATIVE)
+                atomic_fetch_min_explicit(obj, arg, order);
+            else
+                atomic_fetch_min_cas(obj, arg);
+        } else {
+            if (impl == MM_NATIVE)
+                atomic_fetch_max_explicit(obj, arg, order);
+            else
+                atomic_fetch_max_cas(obj, arg);
+        }
+    }
+}
+
+// Время одной операции в наносекундах, усреднённое по всем потокам;
+// *ok сбрасывается, если итоговое значение не совпало с ожидаемым
+template <class T>
+static double minmax_run(
+        unsigned num_threads,
+        uint64_t iters,
+        bool rising,
+        MinMaxOp op,
+        MinMaxImpl impl,
+        int order,
+        bool* ok)
+{
+    std::vector<std::vector<T>> args;
+    for (unsigned id = 0; id < num_threads; id++)
+        args.push_back(minmax_args<T>(id, num_threads, iters, rising, op));
+
+    T initial = op == MM_MIN ? std::numeric_limits<T>::max() : std::numeric_limits<T>::lowest();
+    g_minmax<T>.value = initial;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    run_threads(num_threads, [&](unsigned id) { minmax_thread<T>(args[id], op, impl, order); });
+    auto end = std::chrono::high_resolution_clock::now();
+
+    T expected = initial;
+    for (const auto& a : args) {
+        for (T v : a)
+            expected = op == MM_MIN ? (v < expected ? v : expected) : (v > expected ? v : expected);
+    }
+    T result = g_minmax<T>.value;
+    if (result != expected) {
+        fprintf(stderr,
+                "Ошибка: итоговое значение %s, ожидалось %s\n",
+                std::to_string(result).c_str(),
+                std::to_string(expected).c_str());
+        *ok = false;
+    }
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / num_threads / iters;
+}
+
+template <class T>
+static void minmax_table(
+        const char* type,
+        int order,
+        const char* order_name,
+        unsigned max_threads,
+        uint64_t iters,
+        bool* ok)
+{
+    for (int op = MM_MIN; op <= MM_MAX; op++) {
+        for (int rising = 1; rising >= 0; rising--) {
+            for (unsigned threads = 1; threads <= max_threads; threads++) {
+                double native = minmax_run<T>(threads, iters, rising, static_cast<MinMaxOp>(op), MM_NATIVE, order, ok);
+                double cas = minmax_run<T>(threads, iters, rising, static_cast<MinMaxOp>(op), MM_CAS, order, ok);
+                printf("%-4s %-4s %-8s %-7s %8u %14.2f %14.2f %9.2f\n",
+                       op == MM_MIN ? "min" : "max",
+                       type,
+                       order_name,
+                       rising ? "rising" : "random",
+                       threads,
+                       native,
+                       cas,
+                       cas / native);
+            }
+        }
+    }
+}
+
+int bench_minmax(int argc, char** argv)
+{
+    unsigned max_threads = bench_arg_u64(argc, argv, "threads", NUM_THREADS);
+    uint64_t iters = bench_arg_u64(argc, argv, "iters", ITERATIONS);
+    std::vector<std::string> types = bench_split(bench_arg(argc, argv, "types", "u32,i32,u64,i64"));
+    std::vector<std::string> orders = bench_split(bench_arg(argc, argv, "orders", "seq_cst,relaxed"));
+
+    printf("Атомарные min/max: до %u потоков, %llu операций на поток\n", max_threads, (unsigned long long)iters);
+    printf("%-4s %-4s %-8s %-7s %8s %14s %14s %9s\n",
+           "op",
+           "type",
+           "order",
+           "pattern",
+           "threads",
+           "native ns/op",
+           "cas ns/op",
+           "speedup");
+    bool ok = true;
+    for (const std::string& order_name : orders) {
+        int order;
+        if (order_name == "seq_cst")
+            order = __ATOMIC_SEQ_CST;
+        else if (order_name == "relaxed")
+            order = __ATOMIC_RELAXED;
+        else {
+            fprintf(stderr, "Неизвестный порядок памяти: %s\n", order_name.c_str());
+            return 1;
+        }
+        for (const std::string& type : types) {
+            if (type == "u32")
+                minmax_table<uint32_t>("u32", order, order_name.c_str(), max_threads, iters, &ok);
+            else if (type == "i32")
+                minmax_table<int32_t>("i32", order, order_name.c_str(), max_threads, iters, &ok);
+            else if (type == "u64")
+                minmax_table<uint64_t>("u64", order, order_name.c_str(), max_threads, iters, &ok);
+            else if (type == "i64")
+                minmax_table<int64_t>("i64", order, order_name.c_str(), max_threads, iters, &ok);
+            else {
+                fprintf(stderr, "Неизвестный тип: %s\n", type.c_str());
+                return 1;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+#include "bench.h"
+#include "stdatomic_asm.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+// Открытая нагрузка: потоки выполняют операции не сразу друг за другом, а по
+// расписанию (равномерному или пуассоновскому) с заданной суммарной частотой.
+// Задержка считается от запланированного момента начала, а не от фактического,
+// поэтому очередь, накопившаяся из-за медленных операций, входит в задержку
+// (без coordinated omission). Частота растёт от --min-rate в два раза за шаг,
+// пока достигнутая частота не отстанет от заданной больше чем на 10%.
+//
+// Параметры:
+//   --threads=N           число потоков
+//   --ops=add,exch,cas    операции (load, store, exch, add, cas)
+//   --arrival=poisson     расписание: fixed или poisson
+//   --min-rate=100000     начальная суммарная частота, операций в секунду
+//   --max-rate=N          верхняя граница частоты
+//   --duration=200        длительность одного шага в миллисекундах
+
+enum OpenLoopOp { OL_LOAD, OL_STORE, OL_EXCH, OL_ADD, OL_CAS, OL_OP_COUNT };
+
+static const char* const ol_op_names[OL_OP_COUNT] = {"load", "store", "exch", "add", "cas"};
+
+static PaddedAtomic<uint64_t> g_openloop;
+
+struct alignas(CACHE_LINE_SIZE) OpenLoopStats {
+    LatencyHistogram latency;
+    LatencyHistogram service;
+    uint64_t ops;
+    uint64_t end_tick;
+};
+
+// Расписание потока: запланированные начала операций генерируются по одному
+// прямо в цикле потока, так что память не зависит от частоты и длительности
+class OpenLoopSchedule {
+public:
+    OpenLoopSchedule(unsigned id, unsigned num_threads, double thread_rate, uint64_t duration_ns, bool poisson)
+        : rng_(id + 1), mean_gap_ns_(1e9 / thread_rate), duration_ns_(duration_ns), poisson_(poisson)
+    {
+        // Потоки сдвинуты по фазе на равные доли интервала, чтобы при равномерном
+        // расписании суммарный поток операций тоже был равномерным
+        t_ = poisson ? 0 : mean_gap_ns_ * id / num_threads;
+    }
+
+    // Следующее смещение от начала шага в нс; false, если шаг закончился
+    bool next(double* t_ns)
+    {
+        if (t_ >= duration_ns_)
+            return false;
+        *t_ns = t_;
+        t_ += poisson_ ? -log(1.0 - rng_.next_double()) * mean_gap_ns_ : mean_gap_ns_;
+        return true;
+    }
+
+private:
+    Rng rng_;
+    double mean_gap_ns_;
+    double duration_ns_;
+    bool poisson_;
+    double t_;
+};
+
+static void openloop_execute(OpenLoopOp op, uint64_t i)
+{
+    volatile uint64_t* obj = &g_openloop.value;
+    switch (op) {
+    case OL_LOAD:
+        (void)atomic_load(obj);
+        break;
+    case OL_STORE:
+        atomic_store(obj, i);
+        break;
+    case OL_EXCH:
+        atomic_exchange(obj, i);
+        break;
+    case OL_ADD:
+        atomic_fetch_add(obj, 1);
+        break;
+    default: {
+        uint64_t expected = atomic_load_explicit(obj, __ATOMIC_RELAXED);
+        while (!atomic_cas_bool(obj, &expected, expected + 1)) {
+        }
+        break;
+    }
+    }
+}
+
+static void openloop_thread(OpenLoopOp op, OpenLoopSchedule schedule, uint64_t base, double tpns, OpenLoopStats* stats)
+{
+    uint64_t i = 0;
+    double t_ns;
+    while (schedule.next(&t_ns)) {
+        uint64_t intended = base + static_cast<uint64_t>(t_ns * tpns);
+        uint64_t now;
+        while ((now = rdtscp()) < intended)
+            cpu_relax();
+        openloop_execute(op, i++);
+        uint64_t end = rdtscp();
+        stats->latency.record(end - intended);
+        stats->service.record(end - now);
+    }
+    stats->ops = i;
+    stats->end_tick = rdtscp();
+}
+
+int bench_openloop(int argc, char** argv)
+{
+    unsigned num_threads = bench_arg_u64(argc, argv, "threads", NUM_THREADS);
+    const char* ops = bench_arg(argc, argv, "ops", "add,exch,cas");
+    const char* arrival = bench_arg(argc, argv, "arrival", "poisson");
+    double min_rate = bench_arg_double(argc, argv, "min-rate", 100'000);
+    double max_rate = bench_arg_double(argc, argv, "max-rate", 1e9);
+    uint64_t duration_ns = bench_arg_u64(argc, argv, "duration", 200) * 1'000'000;
+    if (num_threads == 0 || min_rate <= 0) {
+        fprintf(stderr, "Число потоков и частота должны быть положительными\n");
+        return 1;
+    }
+    bool poisson = strcmp(arrival, "poisson") == 0;
+    if (!poisson && strcmp(arrival, "fixed") != 0) {
+        fprintf(stderr, "Неизвестное расписание: %s\n", arrival);
+        return 1;
+    }
+
+    double tpns = ticks_per_ns();
+    printf("Открытая нагрузка: %u потоков, расписание %s, шаг %llu мс, %.3f тактов rdtscp в нс\n",
+           num_threads,
+           poisson ? "poisson" : "fixed",
+           (unsigned long long)(duration_ns / 1'000'000),
+           tpns);
+    printf("%-6s %14s %14s %12s %12s %12s %12s %12s\n",
+           "op",
+           "offered op/s",
+           "achieved op/s",
+           "p50 ns",
+           "p99 ns",
+           "p99.9 ns",
+           "max ns",
+           "service p50");
+
+    for (const std::string& name : bench_split(ops)) {
+        int op = 0;
+        while (op < OL_OP_COUNT && name != ol_op_names[op])
+            op++;
+        if (op == OL_OP_COUNT) {
+            fprintf(stderr, "Неизвестная операция: %s\n", name.c_str());
+            return 1;
+        }
+
+        for (double rate = min_rate; rate <= max_rate; rate *= 2) {
+            std::vector<OpenLoopStats> stats(num_threads);
+
+            // Общая точка отсчёта чуть в будущем, чтобы все потоки успели стартовать
+            uint64_t base = rdtscp() + static_cast<uint64_t>(5'000'000 * tpns);
+            run_threads(num_threads, [&](unsigned id) {
+                OpenLoopSchedule schedule(id, num_threads, rate / num_threads, duration_ns, poisson);
+                openloop_thread(static_cast<OpenLoopOp>(op), schedule, base, tpns, &stats[id]);
+            });
+
+            LatencyHistogram latency, service;
+            uint64_t total = 0;
+            uint64_t last = base;
+            for (const auto& s : stats) {
+                total += s.ops;
+                latency.merge(s.latency);
+                service.merge(s.service);
+                if (s.end_tick > last)
+                    last = s.end_tick;
+            }
+            double achieved = total / ((last - base) / tpns / 1e9);
+            printf("%-6s %14.0f %14.0f %12.0f %12.0f %12.0f %12.0f %12.0f\n",
+                   ol_op_names[op],
+                   rate,
+                   achieved,
+                   latency.percentile(0.5) / tpns,
+                   latency.percentile(0.99) / tpns,
+                   latency.percentile(0.999) / tpns,
+                   latency.max() / tpns,
+                   service.percentile(0.5) / tpns);
+            // Насыщение: система уже не успевает за заданной частотой
+            if (achieved < 0.9 * rate)
+                break;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "bench.h"
+#include "rwlock.h"
+#include "seqlock.h"
+#include "stdatomic_asm.h"
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Разделяемый снимок, который в основном читают и изредка переписывают:
+// SeqLock против блокировки читатель-писатель с распределёнными слотами.
+// Каждый поток выполняет операции с заданной долей записей.
+// Читатель проверяет, что все слова снимка одинаковы, иначе чтение порвано.
+//
+// Параметры:
+//   --threads=N                 максимальное число потоков, перебираются 1..N
+//   --iters=N                   число операций на поток
+//   --ratios=100:0,99:1,90:10   соотношения чтений и записей
+//
+// Порванное чтение — ошибка синхронизации: режим сообщает о нём и возвращает 1.
+
+// Снимок размером в кэш-линию: конфигурация или блок статистики
+struct Snapshot {
+    uint64_t words[8];
+};
+
+enum ReadMostlyImpl { RM_SEQLOCK, RM_RWLOCK, RM_IMPL_COUNT };
+
+static const char* const rm_impl_names[RM_IMPL_COUNT] = {"seqlock", "rwlock"};
+
+struct alignas(CACHE_LINE_SIZE) ReadMostlyStats {
+    uint64_t reads;
+    uint64_t torn;
+    LatencyHistogram write_latency;
+};
+
+struct ReadMostlyShared {
+    SeqLock<Snapshot> seqlock;
+    ReaderWriterLock rwlock;
+    Snapshot guarded;
+
+    explicit ReadMostlyShared(unsigned num_threads) : rwlock(num_threads), guarded()
+    {
+    }
+};
+
+static bool snapshot_consistent(const Snapshot& s)
+{
+    for (uint64_t word : s.words) {
+        if (word != s.words[0])
+            return false;
+    }
+    return true;
+}
+
+static void readmostly_thread(
+        ReadMostlyImpl impl,
+        unsigned id,
+        uint64_t iters,
+        unsigned reads_weight,
+        unsigned writes_weight,
+        ReadMostlyShared* shared,
+        ReadMostlyStats* stats)
+{
+    Rng rng(id + 1);
+    uint64_t version = static_cast<uint64_t>(id) << 32;
+    for (uint64_t i = 0; i < iters; i++) {
+        bool write = rng.next() % (reads_weight + writes_weight) >= reads_weight;
+        if (write) {
+            Snapshot s;
+            version++;
+            for (auto& word : s.words)
+                word = version;
+            uint64_t start = rdtscp();
+            if (impl == RM_SEQLOCK) {
+                shared->seqlock.write(s);
+            } else {
+                shared->rwlock.write_lock();
+                shared->guarded = s;
+                shared->rwlock.write_unlock();
+            }
+            stats->write_latency.record(rdtscp() - start);
+        } else {
+            Snapshot s;
+            if (impl == RM_SEQLOCK) {
+                s = shared->seqlock.read();
+            } else {
+                shared->rwlock.read_lock(id);
+                s = shared->guarded;
+                shared->rwlock.read_unlock(id);
+            }
+            if (!snapshot_consistent(s))
+                stats->torn++;
+            stats->reads++;
+        }
+    }
+}
+
+int bench_readmostly(int argc, char** argv)
+{
+    unsigned max_threads = bench_arg_u64(argc, argv, "threads", NUM_THREADS);
+    uint64_t iters = bench_arg_u64(argc, argv, "iters", ITERATIONS);
+    const char* ratios = bench_arg(argc, argv, "ratios", "100:0,99:1,90:10,50:50");
+
+    double tpns = ticks_per_ns();
+    bool ok = true;
+    printf("Снимок, который в основном читают: до %u потоков, %llu операций на поток\n",
+           max_threads,
+           (unsigned long long)iters);
+    printf("%-8s %8s %8s %14s %14s %12s %8s\n",
+           "impl",
+           "ratio",
+           "threads",
+           "reads Mops/s",
+           "write mean ns",
+           "write p99 ns",
+           "torn");
+
+    for (const std::string& ratio : bench_split(ratios)) {
+        unsigned reads_weight = 0, writes_weight = 0;
+        if (sscanf(ratio.c_str(), "%u:%u", &reads_weight, &writes_weight) != 2 || reads_weight + writes_weight == 0) {
+            fprintf(stderr, "Некорректное соотношение: %s\n", ratio.c_str());
+            return 1;
+        }
+
+        for (int impl = 0; impl < RM_IMPL_COUNT; impl++) {
+            for (unsigned threads = 1; threads <= max_threads; threads++) {
+                ReadMostlyShared shared(threads);
+                std::vector<ReadMostlyStats> stats(threads);
+
+                auto start = std::chrono::high_resolution_clock::now();
+                run_threads(threads, [&](unsigned id) {
+                    readmostly_thread(
+                            static_cast<ReadMostlyImpl>(impl),
+                            id,
+                            iters,
+                            reads_weight,
+                            writes_weight,
+                            &shared,
+                            &stats[id]);
+                });
+                auto end = std::chrono::high_resolution_clock::now();
+                double seconds = std::chrono::duration<double>(end - start).count();
+
+                uint64_t reads = 0, torn = 0;
+                LatencyHistogram write_latency;
+                for (const auto& s : stats) {
+                    reads += s.reads;
+                    torn += s.torn;
+                    write_latency.merge(s.write_latency);
+                }
+                printf("%-8s %8s %8u %14.2f %14.1f %12.1f %8llu\n",
+                       rm_impl_names[impl],
+                       ratio.c_str(),
+                       threads,
+                       reads / seconds / 1e6,
+                       write_latency.mean() / tpns,
+                       write_latency.percentile(0.99) / tpns,
+                       (unsigned long long)torn);
+                if (torn) {
+                    fprintf(stderr,
+                            "Ошибка: %s, %s, %u потоков: %llu порванных чтений\n",
+                            rm_impl_names[impl],
+                            ratio.c_str(),
+                            threads,
+                            (unsigned long long)torn);
+                    ok = false;
+                }
+            }
+        }
+    }
+    bench_print_latency_units();
+    return ok ? 0 : 1;
+}
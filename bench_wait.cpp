@@ -0,0 +1,118 @@
+#include "atomic_wait.h"
+#include "bench.h"
+#include "stdatomic_asm.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+// Ожидание на атомарной переменной: чистое вращение, чистый futex и адаптивное
+// вращение с засыпанием. Один поток ждёт, второй после заданной паузы меняет
+// значение и будит его. Задержка пробуждения считается от момента перед записью
+// нового значения до выхода ожидающего из atomic_wait*.
+//
+// Параметры:
+//   --rounds=N              число пробуждений на каждую паузу
+//   --delays=0,10,100,1000  паузы перед уведомлением в микросекундах
+
+enum WaitKind { WAIT_SPIN, WAIT_PARK, WAIT_ADAPTIVE, WAIT_KIND_COUNT };
+
+static const char* const wait_kind_names[WAIT_KIND_COUNT] = {"spin", "futex", "adaptive"};
+
+static PaddedAtomic<uint32_t> g_wait_seq;
+static PaddedAtomic<uint32_t> g_wait_ack;
+alignas(CACHE_LINE_SIZE) static volatile uint64_t g_notify_time;
+
+static void wait_with(WaitKind kind, volatile uint32_t* obj, uint32_t old)
+{
+    switch (kind) {
+    case WAIT_SPIN:
+        atomic_wait_spin(obj, old);
+        break;
+    case WAIT_PARK:
+        atomic_wait_park(obj, old);
+        break;
+    default:
+        atomic_wait(obj, old);
+        break;
+    }
+}
+
+struct WaitResult {
+    LatencyHistogram latency;
+    uint64_t cpu_ns;
+    uint64_t wall_ns;
+};
+
+static void waiter_thread(WaitKind kind, uint32_t rounds, WaitResult* result)
+{
+    uint64_t cpu_start = bench_clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    uint64_t wall_start = bench_clock_ns(CLOCK_MONOTONIC);
+    for (uint32_t r = 0; r < rounds; r++) {
+        // Сообщаем уведомляющему потоку, что готовы ждать очередного раунда
+        atomic_store(&g_wait_ack.value, r + 1);
+        atomic_notify_one(&g_wait_ack.value);
+        wait_with(kind, &g_wait_seq.value, r);
+        result->latency.record(bench_clock_ns(CLOCK_MONOTONIC) - g_notify_time);
+    }
+    result->cpu_ns = bench_clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    result->wall_ns = bench_clock_ns(CLOCK_MONOTONIC) - wall_start;
+}
+
+static void notifier_thread(uint32_t rounds, uint64_t delay_us)
+{
+    struct timespec delay = {static_cast<time_t>(delay_us / 1'000'000), static_cast<long>(delay_us % 1'000'000) * 1000};
+    for (uint32_t r = 0; r < rounds; r++) {
+        atomic_wait(&g_wait_ack.value, r);
+        if (delay_us)
+            nanosleep(&delay, nullptr);
+        g_notify_time = bench_clock_ns(CLOCK_MONOTONIC);
+        atomic_store(&g_wait_seq.value, r + 1);
+        atomic_notify_one(&g_wait_seq.value);
+    }
+}
+
+int bench_wait(int argc, char** argv)
+{
+    uint32_t rounds = bench_arg_u64(argc, argv, "rounds", 1000);
+    std::vector<uint64_t> delays;
+    for (const std::string& delay : bench_split(bench_arg(argc, argv, "delays", "0,10,100,1000")))
+        delays.push_back(strtoull(delay.c_str(), nullptr, 10));
+    if (rounds == 0) {
+        fprintf(stderr, "Число пробуждений должно быть положительным\n");
+        return 1;
+    }
+
+    printf("Ожидание с уведомлением: %u пробуждений на каждую паузу\n", rounds);
+    printf("%10s %-9s %12s %12s %12s %14s %8s\n",
+           "pause us",
+           "kind",
+           "mean us",
+           "p50 us",
+           "p99 us",
+           "cpu us/wait",
+           "cpu %");
+    for (uint64_t delay_us : delays) {
+        for (int kind = 0; kind < WAIT_KIND_COUNT; kind++) {
+            g_wait_seq.value = 0;
+            g_wait_ack.value = 0;
+            WaitResult result{};
+
+            std::thread waiter(waiter_thread, static_cast<WaitKind>(kind), rounds, &result);
+            std::thread notifier(notifier_thread, rounds, delay_us);
+            waiter.join();
+            notifier.join();
+
+            printf("%10llu %-9s %12.2f %12.2f %12.2f %14.2f %8.1f\n",
+                   (unsigned long long)delay_us,
+                   wait_kind_names[kind],
+                   result.latency.mean() / 1000,
+                   result.latency.percentile(0.5) / 1000.0,
+                   result.latency.percentile(0.99) / 1000.0,
+                   static_cast<double>(result.cpu_ns) / rounds / 1000,
+                   100.0 * result.cpu_ns / result.wall_ns);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,316 @@
+#include "bench.h"
+#include "stdatomic_asm.h"
+#include <algorithm>
+#include <chrono>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Смешанная нагрузка: набор операций с заданными долями, K горячих кэш-линий
+// и равномерное или ципфовское распределение адресов между ними.
+//
+// Параметры:
+//   --threads=N       число потоков
+//   --iters=N         число операций на поток
+//   --mix=load:70,add:20,cas:10
+//                     доли операций (load, store, exch, add, and, or, xor, min, max, cas)
+//   --lines=K         число целевых кэш-линий
+//   --dist=uniform|zipf
+//   --theta=0.99      параметр распределения Ципфа
+//   --width=32        разрядность операндов: 32 или 64, на x86-64 также 8 и 16
+//   --sample=N        печатать временной ряд ops/s по потокам с интервалом N мс
+
+enum WorkloadOp : uint8_t {
+    OP_LOAD,
+    OP_STORE,
+    OP_EXCH,
+    OP_ADD,
+    OP_AND,
+    OP_OR,
+    OP_XOR,
+    OP_MIN,
+    OP_MAX,
+    OP_CAS,
+    OP_COUNT
+};
+
+static const char* const op_names[OP_COUNT] =
+        {"load", "store", "exch", "add", "and", "or", "xor", "min", "max", "cas"};
+
+// Заранее сгенерированная операция: тип и номер кэш-линии
+struct WorkloadItem {
+    uint32_t line;
+    uint8_t op;
+};
+
+struct alignas(CACHE_LINE_SIZE) WorkloadStats {
+    LatencyHistogram latency[OP_COUNT];
+};
+
+// Разбирает строку вида "load:70,add:20,cas:10" в веса операций.
+// Вес — неотрицательное десятичное число, сумма весов не должна переполнять uint64_t
+static bool parse_mix(const char* mix, uint64_t weights[OP_COUNT])
+{
+    std::fill(weights, weights + OP_COUNT, 0);
+    uint64_t total = 0;
+    for (const std::string& item : bench_split(mix)) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos)
+            return false;
+        std::string name = item.substr(0, colon);
+        int op = -1;
+        for (int i = 0; i < OP_COUNT; i++) {
+            if (name == op_names[i])
+                op = i;
+        }
+        if (op < 0)
+            return false;
+        const char* value = item.c_str() + colon + 1;
+        if (!isdigit(static_cast<unsigned char>(*value)))
+            return false;
+        char* end;
+        errno = 0;
+        uint64_t weight = strtoull(value, &end, 10);
+        if (*end != '\0' || errno == ERANGE || weight > UINT64_MAX - total)
+            return false;
+        weights[op] += weight;
+        total += weight;
+    }
+    return true;
+}
+
+// Функция распределения Ципфа для K линий: P(i) ~ 1 / (i + 1)^theta
+static std::vector<double> zipf_cdf(unsigned lines, double theta)
+{
+    std::vector<double> cdf(lines);
+    double sum = 0;
+    for (unsigned i = 0; i < lines; i++) {
+        sum += 1.0 / pow(i + 1, theta);
+        cdf[i] = sum;
+    }
+    for (auto& c : cdf)
+        c /= sum;
+    return cdf;
+}
+
+// Генерация вынесена из замеряемого цикла: поток получает готовый массив операций
+static std::vector<WorkloadItem> generate_items(
+        unsigned id,
+        uint64_t iters,
+        const uint64_t weights[OP_COUNT],
+        unsigned lines,
+        const std::vector<double>* cdf)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < OP_COUNT; i++)
+        total += weights[i];
+
+    Rng rng(id + 1);
+    std::vector<WorkloadItem> items(iters);
+    for (auto& item : items) {
+        uint64_t pick = rng.next() % total;
+        uint8_t op = 0;
+        while (pick >= weights[op]) {
+            pick -= weights[op];
+            op++;
+        }
+        item.op = op;
+        if (cdf)
+            item.line = std::lower_bound(cdf->begin(), cdf->end(), rng.next_double()) - cdf->begin();
+        else
+            item.line = rng.next() % lines;
+        if (item.line >= lines)
+            item.line = lines - 1;
+    }
+    return items;
+}
+
+template <class T>
+static void workload_thread(const std::vector<WorkloadItem>& items, PaddedAtomic<T>* lines, WorkloadStats* stats)
+{
+    volatile T sink = 0;
+    // i — значение операнда, которое переполняется на узких типах; прогресс считается отдельно
+    T i = 0;
+    uint64_t done = 0;
+    for (const auto& item : items) {
+        volatile T* obj = &lines[item.line].value;
+        uint64_t start = rdtscp();
+        switch (item.op) {
+        case OP_LOAD:
+            sink = atomic_load(obj);
+            break;
+        case OP_STORE:
+            atomic_store(obj, i);
+            break;
+        case OP_EXCH:
+            atomic_exchange(obj, i);
+            break;
+        case OP_ADD:
+            atomic_fetch_add(obj, 1);
+            break;
+        case OP_AND:
+            atomic_fetch_and(obj, i);
+            break;
+        case OP_OR:
+            atomic_fetch_or(obj, i);
+            break;
+        case OP_XOR:
+            atomic_fetch_xor(obj, i);
+            break;
+        case OP_MIN:
+            atomic_fetch_min(obj, i);
+            break;
+        case OP_MAX:
+            atomic_fetch_max(obj, i);
+            break;
+        case OP_CAS: {
+            T expected = atomic_load_explicit(obj, __ATOMIC_RELAXED);
+            while (!atomic_cas_bool(obj, &expected, static_cast<T>(expected + 1))) {
+            }
+            break;
+        }
+        }
+        stats->latency[item.op].record(rdtscp() - start);
+        i++;
+        bench_report_progress(++done);
+    }
+    (void)sink;
+}
+
+// Прогон нагрузки на операндах типа T, возвращает время в секундах
+template <class T>
+static double run_workload(
+        unsigned num_threads,
+        unsigned num_lines,
+        const std::vector<std::vector<WorkloadItem>>& items,
+        std::vector<WorkloadStats>& stats,
+        unsigned sample_ms)
+{
+    // Каждая целевая переменная занимает свою кэш-линию
+    std::vector<PaddedAtomic<T>> lines(num_lines);
+    ThroughputSampler sampler(num_threads, sample_ms);
+    if (sample_ms)
+        sampler.start();
+    auto start = std::chrono::high_resolution_clock::now();
+    run_threads(num_threads, [&](unsigned id) {
+        if (sample_ms)
+            bench_progress = sampler.counter(id);
+        workload_thread(items[id], lines.data(), &stats[id]);
+    });
+    auto end = std::chrono::high_resolution_clock::now();
+    if (sample_ms) {
+        sampler.stop();
+        sampler.print();
+    }
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int bench_workload(int argc, char** argv)
+{
+    unsigned num_threads = bench_arg_u64(argc, argv, "threads", NUM_THREADS);
+    uint64_t iters = bench_arg_u64(argc, argv, "iters", ITERATIONS);
+    unsigned num_lines = bench_arg_u64(argc, argv, "lines", 1);
+    const char* mix = bench_arg(argc, argv, "mix", "load:70,add:20,cas:10");
+    const char* dist = bench_arg(argc, argv, "dist", "uniform");
+    double theta = bench_arg_double(argc, argv, "theta", 0.99);
+    unsigned width = bench_arg_u64(argc, argv, "width", 32);
+    unsigned sample_ms = bench_arg_u64(argc, argv, "sample", 0);
+
+    uint64_t weights[OP_COUNT];
+    if (!parse_mix(mix, weights) || std::all_of(weights, weights + OP_COUNT, [](uint64_t w) { return w == 0; })) {
+        fprintf(stderr, "Некорректный набор операций: %s\n", mix);
+        return 1;
+    }
+    if (num_threads == 0 || num_lines == 0) {
+        fprintf(stderr, "Число потоков и кэш-линий должно быть положительным\n");
+        return 1;
+    }
+
+    std::vector<double> cdf;
+    bool zipf = strcmp(dist, "zipf") == 0;
+    if (zipf)
+        cdf = zipf_cdf(num_lines, theta);
+    else if (strcmp(dist, "uniform") != 0) {
+        fprintf(stderr, "Неизвестное распределение: %s\n", dist);
+        return 1;
+    }
+
+#if defined(__x86_64)
+    bool width_supported = width == 8 || width == 16 || width == 32 || width == 64;
+#else
+    bool width_supported = width == 32 || width == 64;
+#endif
+    if (!width_supported) {
+        fprintf(stderr, "Разрядность %u не поддерживается\n", width);
+        return 1;
+    }
+
+    std::vector<std::vector<WorkloadItem>> items;
+    for (unsigned id = 0; id < num_threads; id++)
+        items.push_back(generate_items(id, iters, weights, num_lines, zipf ? &cdf : nullptr));
+
+    std::vector<WorkloadStats> stats(num_threads);
+
+    printf("Смешанная нагрузка: %u потоков, %llu операций на поток, %u бит, %s, %u кэш-линий (%s",
+           num_threads,
+           (unsigned long long)iters,
+           width,
+           mix,
+           num_lines,
+           dist);
+    if (zipf)
+        printf(", theta = %.2f", theta);
+    printf(")\n");
+
+    double seconds;
+    switch (width) {
+#if defined(__x86_64)
+    case 8:
+        seconds = run_workload<uint8_t>(num_threads, num_lines, items, stats, sample_ms);
+        break;
+    case 16:
+        seconds = run_workload<uint16_t>(num_threads, num_lines, items, stats, sample_ms);
+        break;
+#endif
+    case 64:
+        seconds = run_workload<uint64_t>(num_threads, num_lines, items, stats, sample_ms);
+        break;
+    default:
+        seconds = run_workload<uint32_t>(num_threads, num_lines, items, stats, sample_ms);
+        break;
+    }
+
+    double tpns = ticks_per_ns();
+    printf("%-6s %12s %14s %10s %10s %10s %10s\n", "op", "count", "ops/s", "mean ns", "p50 ns", "p99 ns", "p99.9 ns");
+    LatencyHistogram all;
+    for (int op = 0; op < OP_COUNT; op++) {
+        LatencyHistogram latency;
+        for (const auto& s : stats)
+            latency.merge(s.latency[op]);
+        all.merge(latency);
+        if (latency.count() == 0)
+            continue;
+        printf("%-6s %12llu %14.0f %10.1f %10.1f %10.1f %10.1f\n",
+               op_names[op],
+               (unsigned long long)latency.count(),
+               latency.count() / seconds,
+               latency.mean() / tpns,
+               latency.percentile(0.5) / tpns,
+               latency.percentile(0.99) / tpns,
+               latency.percentile(0.999) / tpns);
+    }
+    printf("%-6s %12llu %14.0f %10.1f %10.1f %10.1f %10.1f\n",
+           "all",
+           (unsigned long long)all.count(),
+           all.count() / seconds,
+           all.mean() / tpns,
+           all.percentile(0.5) / tpns,
+           all.percentile(0.99) / tpns,
+           all.percentile(0.999) / tpns);
+    bench_print_latency_units();
+    return 0;
+}
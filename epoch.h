@@ -0,0 +1,122 @@
+#pragma once
+
+#include "stdatomic_asm.h"
+#include <stdint.h>
+#include <vector>
+
+// Освобождение памяти по эпохам (epoch-based reclamation) для lock-free структур.
+// Поток, работающий со структурой, объявляет текущую глобальную эпоху (enter) и
+// снимает объявление по окончании операции (exit). Удалённый из структуры узел
+// откладывается (retire) в корзину эпохи, в которой его удалили, и возвращается
+// в пул, когда глобальная эпоха уходит на две вперёд: к этому моменту ни один
+// поток уже не может держать на него ссылку.
+//
+// Узлы берутся из пулов потоков, которые пополняются блоками по POOL_CHUNK
+// узлов, так что аллокатор не попадает на горячий путь.
+
+// Размер блока, которым пополняется пул потока
+#define POOL_CHUNK 256
+
+// Через столько отложенных узлов поток пытается сдвинуть глобальную эпоху
+#define EPOCH_SCAN_INTERVAL 64
+
+template <class Node>
+class EpochReclaimer {
+public:
+    explicit EpochReclaimer(unsigned num_threads) : global_epoch_(0), threads_(num_threads)
+    {
+    }
+
+    ~EpochReclaimer()
+    {
+        for (auto& t : threads_) {
+            for (Node* chunk : t.chunks)
+                delete[] chunk;
+        }
+    }
+
+    // Начало операции: после объявления эпохи можно читать разделяемые узлы
+    void enter(unsigned id)
+    {
+        uint64_t epoch = atomic_load_explicit(&global_epoch_, __ATOMIC_ACQUIRE);
+        // Обмен служит полным барьером: объявление видно раньше любых чтений структуры
+        atomic_exchange(&threads_[id].state, epoch << 1 | 1);
+    }
+
+    void exit(unsigned id)
+    {
+        atomic_store_explicit(&threads_[id].state, 0, __ATOMIC_RELEASE);
+    }
+
+    Node* alloc(unsigned id)
+    {
+        ThreadState& t = threads_[id];
+        if (t.free.empty()) {
+            try_advance();
+            collect(t);
+        }
+        if (t.free.empty()) {
+            Node* chunk = new Node[POOL_CHUNK];
+            t.chunks.push_back(chunk);
+            for (int i = POOL_CHUNK - 1; i >= 0; i--)
+                t.free.push_back(&chunk[i]);
+        }
+        Node* node = t.free.back();
+        t.free.pop_back();
+        return node;
+    }
+
+    // Откладывает узел, уже недостижимый из структуры
+    void retire(unsigned id, Node* node)
+    {
+        ThreadState& t = threads_[id];
+        if (++t.retired % EPOCH_SCAN_INTERVAL == 0)
+            try_advance();
+        uint64_t epoch = collect(t);
+        t.limbo[epoch % 3].push_back(node);
+        t.limbo_epoch[epoch % 3] = epoch;
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) ThreadState {
+        // Объявленная эпоха, сдвинутая на бит, младший бит — поток внутри операции
+        volatile uint64_t state;
+        uint64_t retired;
+        std::vector<Node*> limbo[3];
+        uint64_t limbo_epoch[3];
+        std::vector<Node*> free;
+        std::vector<Node*> chunks;
+
+        ThreadState() : state(0), retired(0), limbo_epoch()
+        {
+        }
+    };
+
+    // Эпоха сдвигается, только если все потоки внутри операций уже её объявили
+    void try_advance()
+    {
+        uint64_t epoch = atomic_load_explicit(&global_epoch_, __ATOMIC_ACQUIRE);
+        for (auto& t : threads_) {
+            uint64_t state = atomic_load(&t.state);
+            if ((state & 1) && (state >> 1) != epoch)
+                return;
+        }
+        atomic_cas_bool(&global_epoch_, &epoch, epoch + 1);
+    }
+
+    // Возвращает в пул корзины, отстающие от глобальной эпохи хотя бы на две
+    uint64_t collect(ThreadState& t)
+    {
+        uint64_t epoch = atomic_load_explicit(&global_epoch_, __ATOMIC_ACQUIRE);
+        for (int i = 0; i < 3; i++) {
+            if (!t.limbo[i].empty() && t.limbo_epoch[i] + 2 <= epoch) {
+                t.free.insert(t.free.end(), t.limbo[i].begin(), t.limbo[i].end());
+                t.limbo[i].clear();
+            }
+        }
+        return epoch;
+    }
+
+    alignas(CACHE_LINE_SIZE) volatile uint64_t global_epoch_;
+    std::vector<ThreadState> threads_;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "stdatomic_asm.h"
+#include <sched.h>
+#include <stdint.h>
+#include <vector>
+
+// Flat combining: вместо того чтобы каждый поток сам менял разделяемый объект,
+// потоки публикуют запросы в своих слотах, а один поток-комбайнер, захвативший
+// блокировку, выполняет пачку чужих запросов подряд. Объект при этом остаётся
+// в кэше комбайнера, и вместо передачи линии на каждую операцию линия слота
+// переходит дважды: к комбайнеру за запросом и обратно с результатом.
+//
+// Object — обычная последовательная структура без атомарных операций,
+// доступ к ней есть только у комбайнера.
+
+// Число проходов комбайнера по слотам за один захват блокировки
+#define COMBINE_PASSES 2
+
+// Через столько итераций ожидания поток уступает процессор (важно при
+// числе потоков больше числа ядер, иначе комбайнер может не получить время)
+#define COMBINE_YIELD_SPINS 1024
+
+template <class Object>
+class FlatCombiner {
+public:
+    // Операция над объектом, выполняется комбайнером
+    typedef uint64_t (*Operation)(Object& object, uint64_t arg);
+
+    explicit FlatCombiner(unsigned num_slots) : lock_(0), object_(), slots_(num_slots), batches_(0), combined_(0)
+    {
+    }
+
+    // Выполняет op(object, arg) от имени потока, владеющего слотом slot
+    uint64_t apply(unsigned slot, Operation op, uint64_t arg)
+    {
+        Slot& s = slots_[slot];
+        s.op = op;
+        s.arg = arg;
+        atomic_store_explicit(&s.pending, 1, __ATOMIC_RELEASE);
+
+        for (uint32_t spins = 1;; spins++) {
+            if (atomic_load_explicit(&s.pending, __ATOMIC_ACQUIRE) == 0)
+                return s.result;
+            if (atomic_load_explicit(&lock_, __ATOMIC_RELAXED) == 0
+                && atomic_exchange_explicit(&lock_, 1, __ATOMIC_ACQUIRE) == 0) {
+                combine();
+                atomic_store_explicit(&lock_, 0, __ATOMIC_RELEASE);
+                continue;
+            }
+            if (spins % COMBINE_YIELD_SPINS == 0)
+                sched_yield();
+            else
+                cpu_relax();
+        }
+    }
+
+    // Объект для чтения, когда потоки уже остановлены
+    Object& object()
+    {
+        return object_;
+    }
+
+    // Число захватов блокировки и выполненных при этом запросов
+    uint64_t batches() const
+    {
+        return batches_;
+    }
+
+    uint64_t combined() const
+    {
+        return combined_;
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        Operation op;
+        uint64_t arg;
+        uint64_t result;
+        volatile uint32_t pending;
+    };
+
+    void combine()
+    {
+        batches_++;
+        for (int pass = 0; pass < COMBINE_PASSES; pass++) {
+            for (auto& s : slots_) {
+                if (atomic_load_explicit(&s.pending, __ATOMIC_ACQUIRE) == 0)
+                    continue;
+                s.result = s.op(object_, s.arg);
+                atomic_store_explicit(&s.pending, 0, __ATOMIC_RELEASE);
+                combined_++;
+            }
+        }
+    }
+
+    alignas(CACHE_LINE_SIZE) volatile uint32_t lock_;
+    alignas(CACHE_LINE_SIZE) Object object_;
+    std::vector<Slot> slots_;
+    uint64_t batches_;
+    uint64_t combined_;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "epoch.h"
+#include "stdatomic_asm.h"
+#include <stdint.h>
+
+// Lock-free контейнеры поверх CAS из stdatomic_asm.h: стек Трайбера и очередь
+// Майкла-Скотта. Каждая операция получает номер потока, по которому выбираются
+// его пул узлов и слот эпохи. Узлы освобождаются через EpochReclaimer, поэтому
+// узел не переиспользуется, пока на него может ссылаться другой поток, и CAS на
+// голове не страдает от ABA.
+
+template <class T>
+class TreiberStack {
+public:
+    explicit TreiberStack(unsigned num_threads) : head_(nullptr), epochs_(num_threads)
+    {
+    }
+
+    void push(unsigned id, const T& value)
+    {
+        Node* node = epochs_.alloc(id);
+        node->value = value;
+        Node* head = atomic_load_explicit(&head_, __ATOMIC_RELAXED);
+        do {
+            node->next = head;
+        } while (!atomic_cas_bool(&head_, &head, node));
+    }
+
+    bool pop(unsigned id, T* value)
+    {
+        epochs_.enter(id);
+        Node* head = atomic_load_explicit(&head_, __ATOMIC_ACQUIRE);
+        while (head && !atomic_cas_bool(&head_, &head, head->next)) {
+        }
+        if (head) {
+            *value = head->value;
+            epochs_.retire(id, head);
+        }
+        epochs_.exit(id);
+        return head != nullptr;
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* volatile next;
+    };
+
+    alignas(CACHE_LINE_SIZE) Node* volatile head_;
+    EpochReclaimer<Node> epochs_;
+};
+
+template <class T>
+class MichaelScottQueue {
+public:
+    explicit MichaelScottQueue(unsigned num_threads) : epochs_(num_threads)
+    {
+        // Фиктивный узел: голова всегда указывает на уже извлечённый элемент
+        Node* dummy = epochs_.alloc(0);
+        dummy->next = nullptr;
+        head_ = dummy;
+        tail_ = dummy;
+    }
+
+    void enqueue(unsigned id, const T& value)
+    {
+        Node* node = epochs_.alloc(id);
+        node->value = value;
+        node->next = nullptr;
+
+        epochs_.enter(id);
+        for (;;) {
+            Node* tail = atomic_load_explicit(&tail_, __ATOMIC_ACQUIRE);
+            Node* next = atomic_load_explicit(&tail->next, __ATOMIC_ACQUIRE);
+            if (tail != atomic_load_explicit(&tail_, __ATOMIC_RELAXED))
+                continue;
+            if (next) {
+                // Хвост отстал: помогаем его сдвинуть и пробуем снова
+                atomic_cas_bool(&tail_, &tail, next);
+                continue;
+            }
+            if (atomic_cas_bool(&tail->next, &next, node)) {
+                atomic_cas_bool(&tail_, &tail, node);
+                break;
+            }
+        }
+        epochs_.exit(id);
+    }
+
+    bool dequeue(unsigned id, T* value)
+    {
+        epochs_.enter(id);
+        for (;;) {
+            Node* head = atomic_load_explicit(&head_, __ATOMIC_ACQUIRE);
+            Node* tail = atomic_load_explicit(&tail_, __ATOMIC_ACQUIRE);
+            Node* next = atomic_load_explicit(&head->next, __ATOMIC_ACQUIRE);
+            if (head != atomic_load_explicit(&head_, __ATOMIC_RELAXED))
+                continue;
+            if (!next) {
+                epochs_.exit(id);
+                return false;
+            }
+            if (head == tail) {
+                atomic_cas_bool(&tail_, &tail, next);
+                continue;
+            }
+            // Значение читается до CAS: после него узел next может уже извлечь другой поток
+            T result = next->value;
+            if (atomic_cas_bool(&head_, &head, next)) {
+                *value = result;
+                epochs_.retire(id, head);
+                epochs_.exit(id);
+                return true;
+            }
+        }
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* volatile next;
+    };
+
+    alignas(CACHE_LINE_SIZE) Node* volatile head_;
+    alignas(CACHE_LINE_SIZE) Node* volatile tail_;
+    EpochReclaimer<Node> epochs_;
+};
@@ -1,257 +1,332 @@
+#include "bench.h"
 #include "stdatomic_asm.h"
 #include <chrono>
 #include <iostream>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <thread>
 #include <vector>
 
-// Количество потоков и число итераций для каждого потока
-#define NUM_THREADS 2
-#define ITERATIONS 1'000'000
-
-// Глобальные разделяемые переменные для тестов
-volatile uint32_t g_var_exch = 0;
-volatile uint32_t g_var_add = 0;
-volatile uint32_t g_var_and = 0xffffffff;
-volatile uint32_t g_var_or = 0;
-volatile uint32_t g_var_xor = 0;
-volatile uint32_t g_var_cas = 0;
+// Глобальные разделяемые переменные для тестов, по одному набору на каждую разрядность
+template <class T>
+volatile T g_var_exch = 0;
+template <class T>
+volatile T g_var_add = 0;
+template <class T>
+volatile T g_var_and = static_cast<T>(~T(0));
+template <class T>
+volatile T g_var_or = 0;
+template <class T>
+volatile T g_var_xor = 0;
+template <class T>
+volatile T g_var_cas = 0;
 
 volatile uint64_t count = 0;
 
+// Число итераций на поток и интервал сэмплирования (0 — без временного ряда);
+// по умолчанию тесты работают как раньше, режимы могут их переопределить
+uint64_t g_iterations = ITERATIONS;
+unsigned g_sample_ms = 0;
 
-#if defined(__x86_64)
-uint64_t rdtscp()
-{
-    uint32_t lo, hi;
-    asm volatile("rdtscp" : "=a"(lo), "=d"(hi)::"rcx"); // RDTSCP
-    return (static_cast<uint64_t>(hi) << 32) | lo;
-}
-#endif
-
-#if defined(__riscv)
-uint64_t rdtscp() {
-    uint64_t time;
-    asm volatile ("csrr %0, time" : "=r"(time)); // Читаем CSR time
-    return time;
-}
-#endif
-
-// Функции, выполняемые потоками для атомарного сложения
+// Функции, выполняемые потоками; T задаёт разрядность операнда
 
+template <class T>
 void thread_func_exch()
 {
     uint64_t start;
-    for (int i = 1; i <= ITERATIONS; i++) {
+    for (uint64_t i = 1; i <= g_iterations; i++) {
         start = rdtscp();
-        atomic_exchange(&g_var_exch, i);
+        atomic_exchange(&g_var_exch<T>, static_cast<T>(i));
         count += rdtscp() - start;
+        bench_report_progress(i);
     }
 }
 
+template <class T>
 void thread_func_add()
 {
     uint64_t start;
-    for (int i = 0; i < ITERATIONS; i++) {
+    for (uint64_t i = 0; i < g_iterations; i++) {
         start = rdtscp();
-        atomic_fetch_add(&g_var_add, 1);
+        atomic_fetch_add(&g_var_add<T>, 1);
         count += rdtscp() - start;
+        bench_report_progress(i + 1);
     }
 }
 
+template <class T>
 void thread_func_and()
 {
     uint64_t start;
-    for (int i = 0; i < ITERATIONS; i++) {
+    for (uint64_t i = 0; i < g_iterations; i++) {
         start = rdtscp();
-        atomic_fetch_and(&g_var_and, i);
+        atomic_fetch_and(&g_var_and<T>, static_cast<T>(i));
         count += rdtscp() - start;
+        bench_report_progress(i + 1);
     }
 }
 
+template <class T>
 void thread_func_or()
 {
     uint64_t start;
-    for (int i = 0; i < ITERATIONS; i++) {
+    for (uint64_t i = 0; i < g_iterations; i++) {
         start = rdtscp();
-        atomic_fetch_or(&g_var_or, i);
+        atomic_fetch_or(&g_var_or<T>, static_cast<T>(i));
         count += rdtscp() - start;
+        bench_report_progress(i + 1);
     }
 }
 
+template <class T>
 void thread_func_xor()
 {
     uint64_t start;
-    for (int i = 0; i < ITERATIONS; i++) {
+    for (uint64_t i = 0; i < g_iterations; i++) {
         start = rdtscp();
-        atomic_fetch_xor(&g_var_xor, i);
+        atomic_fetch_xor(&g_var_xor<T>, static_cast<T>(i));
         count += rdtscp() - start;
+        bench_report_progress(i + 1);
     }
 }
 
+template <class T>
 void thread_func_cas()
 {
     uint64_t start;
-    for (int i = 0; i < ITERATIONS; i++) {
-        uint32_t expected;
+    for (uint64_t i = 0; i < g_iterations; i++) {
+        T expected;
         start = rdtscp();
         do {
-            expected = g_var_cas;
-#ifdef __riscv
-        } while (atomic_compare_exchange_strong(&g_var_cas, &expected, expected + 1) != expected);
-#elif defined(__x86_64)
-        } while (atomic_compare_exchange_strong(&g_var_cas, &expected, expected + 1) != true);
-#endif
+            expected = g_var_cas<T>;
+        } while (!atomic_cas_bool(&g_var_cas<T>, &expected, static_cast<T>(expected + 1)));
         count += rdtscp() - start;
+        bench_report_progress(i + 1);
     }
 }
 
-void test_exch()
+// Запускает func в NUM_THREADS потоках; при g_sample_ms печатает временной ряд ops/s
+void run_test_threads(void (*func)())
 {
-    auto start = std::chrono::high_resolution_clock::now();
+    ThroughputSampler sampler(NUM_THREADS, g_sample_ms);
+    if (g_sample_ms)
+        sampler.start();
 
     {
         std::vector<std::thread> threads;
         for (int i = 0; i < NUM_THREADS; i++) {
-            threads.emplace_back(thread_func_exch);
+            threads.emplace_back([&sampler, func, i] {
+                if (g_sample_ms)
+                    bench_progress = sampler.counter(i);
+                func();
+            });
         }
         for (auto& t : threads) {
             t.join();
         }
     }
 
+    if (g_sample_ms) {
+        sampler.stop();
+        sampler.print();
+    }
+}
+
+// Запускает func в NUM_THREADS потоках и возвращает время одной операции в секундах
+double run_test(void (*func)())
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    run_test_threads(func);
+
     auto end = std::chrono::high_resolution_clock::now();
 
-    std::chrono::duration<double> duration = (end - start) / NUM_THREADS / ITERATIONS;
+    std::chrono::duration<double> duration = end - start;
+    return duration.count() / NUM_THREADS / g_iterations;
+}
 
-    std::cout << "Атомарный обмен за " << duration.count() << " секунд\n";
+template <class T = uint32_t>
+void test_exch()
+{
+    std::cout << "Атомарный обмен за " << run_test(thread_func_exch<T>) << " секунд\n";
 }
 
+template <class T = uint32_t>
 void test_exch_timer()
 {
     count = 0;
 
-    {
-        std::vector<std::thread> threads;
-        for (int i = 0; i < NUM_THREADS; i++) {
-            threads.emplace_back(thread_func_exch);
-        }
-        for (auto& t : threads) {
-            t.join();
-        }
-    }
+    run_test_threads(thread_func_exch<T>);
 
-    std::cout << "Атомарный обмен за " << count / ITERATIONS << " тактов\n";
+    std::cout << "Атомарный обмен за " << count / g_iterations << " тактов\n";
 }
 
+template <class T = uint32_t>
 void test_add()
 {
-    auto start = std::chrono::high_resolution_clock::now();
-
-    {
-        std::vector<std::thread> threads;
-        for (int i = 0; i < NUM_THREADS; i++) {
-            threads.emplace_back(thread_func_add);
-        }
-        for (auto& t : threads) {
-            t.join();
-        }
-    }
-
-    auto end = std::chrono::high_resolution_clock::now();
-
-    std::chrono::duration<double> duration = (end - start) / NUM_THREADS / ITERATIONS;
-
-    std::cout << "Атомарное сложение за " << duration.count() << " секунд\n";
+    std::cout << "Атомарное сложение за " << run_test(thread_func_add<T>) << " секунд\n";
 }
 
+template <class T = uint32_t>
 void test_and()
 {
-    auto start = std::chrono::high_resolution_clock::now();
-
-    {
-        std::vector<std::thread> threads;
-        for (int i = 0; i < NUM_THREADS; i++) {
-            threads.emplace_back(thread_func_and);
-        }
-        for (auto& t : threads) {
-            t.join();
-        }
-    }
-
-    auto end = std::chrono::high_resolution_clock::now();
-
-    std::chrono::duration<double> duration = (end - start) / NUM_THREADS / ITERATIONS;
-
-    std::cout << "Атомарное и за " << duration.count() << " секунд\n";
+    std::cout << "Атомарное и за " << run_test(thread_func_and<T>) << " секунд\n";
 }
 
+template <class T = uint32_t>
 void test_or()
 {
-    auto start = std::chrono::high_resolution_clock::now();
-
-    {
-        std::vector<std::thread> threads;
-        for (int i = 0; i < NUM_THREADS; i++) {
-            threads.emplace_back(thread_func_or);
-        }
-        for (auto& t : threads) {
-            t.join();
-        }
-    }
-
-    auto end = std::chrono::high_resolution_clock::now();
-
-    std::chrono::duration<double> duration = (end - start) / NUM_THREADS / ITERATIONS;
-
-    std::cout << "Атомарное или за " << duration.count() << " секунд\n";
+    std::cout << "Атомарное или за " << run_test(thread_func_or<T>) << " секунд\n";
 }
 
+template <class T = uint32_t>
 void test_xor()
 {
-    auto start = std::chrono::high_resolution_clock::now();
+    std::cout << "Атомарное искл или за " << run_test(thread_func_xor<T>) << " секунд\n";
+}
 
-    {
-        std::vector<std::thread> threads;
-        for (int i = 0; i < NUM_THREADS; i++) {
-            threads.emplace_back(thread_func_xor);
-        }
-        for (auto& t : threads) {
-            t.join();
-        }
-    }
+template <class T = uint32_t>
+void test_cas()
+{
+    std::cout << "Атомарное CAS за " << run_test(thread_func_cas<T>) << " секунд\n";
+}
 
-    auto end = std::chrono::high_resolution_clock::now();
+// Одна строка таблицы разрядностей: операция и её поток для каждой ширины операнда
+struct WidthTest {
+    const char* name;
+#if defined(__x86_64)
+    void (*func8)();
+    void (*func16)();
+#endif
+    void (*func32)();
+    void (*func64)();
+};
 
-    std::chrono::duration<double> duration = (end - start) / NUM_THREADS / ITERATIONS;
+// На RISC-V 8- и 16-битные варианты не инстанцируются: AMO и LR/SC там есть только для слов
+#if defined(__x86_64)
+#define WIDTH_TEST(name, func) {name, func<uint8_t>, func<uint16_t>, func<uint32_t>, func<uint64_t>}
+#else
+#define WIDTH_TEST(name, func) {name, func<uint32_t>, func<uint64_t>}
+#endif
 
-    std::cout << "Атомарное искл или за " << duration.count() << " секунд\n";
+static const WidthTest width_tests[] = {
+        WIDTH_TEST("exch", thread_func_exch),
+        WIDTH_TEST("add", thread_func_add),
+        WIDTH_TEST("and", thread_func_and),
+        WIDTH_TEST("or", thread_func_or),
+        WIDTH_TEST("xor", thread_func_xor),
+        WIDTH_TEST("cas", thread_func_cas),
+};
+
+// Время каждой операции для 32- и 64-битных операндов, на x86-64 также для 8 и 16 бит
+// (на RISC-V AMO и LR/SC работают только со словами .w и .d)
+int bench_widths(int, char**)
+{
+    printf("Время атомарных операций (нс) по разрядности операнда, %d потоков и %d итераций\n",
+           NUM_THREADS,
+           ITERATIONS);
+#if defined(__x86_64)
+    printf("%-6s %10s %10s %10s %10s\n", "op", "u8", "u16", "u32", "u64");
+#else
+    printf("%-6s %10s %10s\n", "op", "u32", "u64");
+#endif
+    for (const auto& test : width_tests) {
+        printf("%-6s", test.name);
+#if defined(__x86_64)
+        printf(" %10.2f", run_test(test.func8) * 1e9);
+        printf(" %10.2f", run_test(test.func16) * 1e9);
+#endif
+        printf(" %10.2f", run_test(test.func32) * 1e9);
+        printf(" %10.2f\n", run_test(test.func64) * 1e9);
+    }
+    return 0;
 }
 
-void test_cas()
+// Одна операция с временным рядом ops/s по потокам: видно троттлинг частоты
+// и интервалы, когда планировщик снял поток с ядра.
+// Параметры: --op=exch|add|and|or|xor|cas, --width=32, --iters=N, --sample=10 (мс)
+int bench_timeline(int argc, char** argv)
 {
-    auto start = std::chrono::high_resolution_clock::now();
-
-    {
-        std::vector<std::thread> threads;
-        for (int i = 0; i < NUM_THREADS; i++) {
-            threads.emplace_back(thread_func_cas);
-        }
-        for (auto& t : threads) {
-            t.join();
+    const char* op = bench_arg(argc, argv, "op", "exch");
+    unsigned width = bench_arg_u64(argc, argv, "width", 32);
+    g_iterations = bench_arg_u64(argc, argv, "iters", 100 * ITERATIONS);
+    g_sample_ms = bench_arg_u64(argc, argv, "sample", 10);
+    if (g_sample_ms == 0)
+        g_sample_ms = 1;
+
+    const WidthTest* test = nullptr;
+    for (const auto& t : width_tests) {
+        if (strcmp(t.name, op) == 0)
+            test = &t;
+    }
+    void (*func)() = nullptr;
+    if (test) {
+        switch (width) {
+#if defined(__x86_64)
+        case 8:
+            func = test->func8;
+            break;
+        case 16:
+            func = test->func16;
+            break;
+#endif
+        case 32:
+            func = test->func32;
+            break;
+        case 64:
+            func = test->func64;
+            break;
         }
     }
+    if (!func) {
+        fprintf(stderr, "Неизвестная операция %s или разрядность %u\n", op, width);
+        return 1;
+    }
 
-    auto end = std::chrono::high_resolution_clock::now();
-
-    std::chrono::duration<double> duration = (end - start) / NUM_THREADS / ITERATIONS;
-
-    std::cout << "Атомарное CAS за " << duration.count() << " секунд\n";
+    printf("Операция %s (%u бит), %d потоков и %llu итераций\n",
+           op,
+           width,
+           NUM_THREADS,
+           (unsigned long long)g_iterations);
+    double seconds = run_test(func);
+    printf("В среднем %.2f нс на операцию\n", seconds * 1e9);
+    return 0;
 }
 
-int main()
+// Режимы запуска: ./prog <режим> [--параметр=значение ...]
+struct BenchMode {
+    const char* name;
+    int (*run)(int argc, char** argv);
+    const char* description;
+};
+
+static const BenchMode bench_modes[] = {
+        {"workload", bench_workload, "смешанная нагрузка с заданными долями операций и распределением адресов"},
+        {"minmax", bench_minmax, "атомарные min/max: amomin/amomax против CAS-цикла"},
+        {"widths", bench_widths, "базовые операции для операндов 8/16 (x86-64), 32 и 64 бит"},
+        {"wait", bench_wait, "ожидание с уведомлением: вращение, futex и вращение с засыпанием"},
+        {"combining", bench_combining, "flat combining против прямых AMO и CAS на общем счётчике"},
+        {"readmostly", bench_readmostly, "SeqLock и блокировка читатель-писатель при преобладании чтений"},
+        {"timeline", bench_timeline, "временной ряд ops/s по потокам для одной операции"},
+        {"lockfree", bench_lockfree, "стек Трайбера и очередь Майкла-Скотта с освобождением по эпохам"},
+        {"openloop", bench_openloop, "открытая нагрузка с заданной частотой: задержка от запланированного начала"},
+        {"litmus", bench_litmus, "лакмусовые тесты MP, SB, LB, IRIW, 2+2W для всех вариантов упорядочивания"},
+};
+
+int main(int argc, char** argv)
 {
+    if (argc > 1) {
+        for (const auto& mode : bench_modes) {
+            if (strcmp(argv[1], mode.name) == 0)
+                return mode.run(argc, argv);
+        }
+        fprintf(stderr, "Неизвестный режим %s, доступные режимы:\n", argv[1]);
+        for (const auto& mode : bench_modes)
+            fprintf(stderr, "  %-10s %s\n", mode.name, mode.description);
+        return 1;
+    }
+
 #ifdef __riscv
     printf("Тестирование атомарных операций для RISC-V с использованием %d потоков и %d итераций\n",
            NUM_THREADS,
@@ -262,7 +337,7 @@ int main()
            ITERATIONS);
 #endif
     test_exch_timer();
-    std::cout << "g_var_exch = " << g_var_exch << '\n';
+    std::cout << "g_var_exch = " << g_var_exch<uint32_t> << '\n';
 
     // test_exch();
     // test_add();
@@ -273,12 +348,12 @@ int main()
 
     // // Вывод итоговых значений
     // std::cout << "Итоговые значения: ";
-    // std::cout << "g_var_exch = " << g_var_exch;
-    // std::cout << ", g_var_add = " << g_var_add;
-    // std::cout << ", g_var_and = " << g_var_and;
-    // std::cout << ", g_var_or = " << g_var_or;
-    // std::cout << ", g_var_xor = " << g_var_xor;
-    // std::cout << ", g_var_cas = " << g_var_cas;
+    // std::cout << "g_var_exch = " << g_var_exch<uint32_t>;
+    // std::cout << ", g_var_add = " << g_var_add<uint32_t>;
+    // std::cout << ", g_var_and = " << g_var_and<uint32_t>;
+    // std::cout << ", g_var_or = " << g_var_or<uint32_t>;
+    // std::cout << ", g_var_xor = " << g_var_xor<uint32_t>;
+    // std::cout << ", g_var_cas = " << g_var_cas<uint32_t>;
     // std::cout << '\n';
     // return 0;
 }
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "stdatomic_asm.h"
+#include <stdint.h>
+#include <vector>
+
+// Блокировка читатель-писатель с распределённым индикатором читателей.
+// Каждый читатель отмечается счётчиком в своей кэш-линии (слот выбирается по
+// номеру потока), поэтому читатели не передают друг другу одну и ту же линию.
+// Писатель выставляет флаг и ждёт, пока все слоты обнулятся; читатель,
+// увидевший флаг, снимает отметку и ждёт писателя, так что писатели в приоритете.
+//
+// Отметка читателя делается AMO (на RISC-V .aqrl), после неё достаточно
+// acquire-загрузки флага писателя — отдельный fence rw,rw не нужен.
+
+class ReaderWriterLock {
+public:
+    explicit ReaderWriterLock(unsigned num_slots) : writer_(0), slots_(num_slots)
+    {
+    }
+
+    void read_lock(unsigned id)
+    {
+        volatile uint32_t* readers = &slots_[id % slots_.size()].readers;
+        for (;;) {
+            atomic_fetch_add(readers, 1);
+            if (atomic_load_explicit(&writer_, __ATOMIC_ACQUIRE) == 0)
+                return;
+            atomic_fetch_sub_explicit(readers, 1, __ATOMIC_RELEASE);
+            while (atomic_load_explicit(&writer_, __ATOMIC_RELAXED) != 0)
+                cpu_relax();
+        }
+    }
+
+    void read_unlock(unsigned id)
+    {
+        atomic_fetch_sub_explicit(&slots_[id % slots_.size()].readers, 1, __ATOMIC_RELEASE);
+    }
+
+    void write_lock()
+    {
+        while (atomic_exchange(&writer_, 1) != 0) {
+            while (atomic_load_explicit(&writer_, __ATOMIC_RELAXED) != 0)
+                cpu_relax();
+        }
+        for (auto& slot : slots_) {
+            while (atomic_load_explicit(&slot.readers, __ATOMIC_ACQUIRE) != 0)
+                cpu_relax();
+        }
+    }
+
+    void write_unlock()
+    {
+        atomic_store_explicit(&writer_, 0, __ATOMIC_RELEASE);
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) ReaderSlot {
+        volatile uint32_t readers;
+    };
+
+    alignas(CACHE_LINE_SIZE) volatile uint32_t writer_;
+    std::vector<ReaderSlot> slots_;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "stdatomic_asm.h"
+#include <stdint.h>
+#include <type_traits>
+
+// SeqLock для редко меняющихся снимков (конфигурация, статистика).
+// Читатель ничего не пишет в разделяемую память: он читает счётчик версии,
+// копирует данные и перечитывает счётчик; нечётная или изменившаяся версия
+// означает, что копия могла порваться, и чтение повторяется.
+// Писатели захватывают нечётную версию CAS-ом, поэтому их может быть несколько.
+//
+// Данные копируются 64-битными словами через relaxed-загрузки и -записи,
+// поэтому T должен быть тривиально копируемым и кратным 8 байтам.
+
+template <class T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable type");
+    static_assert(sizeof(T) % sizeof(uint64_t) == 0, "SeqLock copies whole 64-bit words");
+
+public:
+    SeqLock() : seq_(0), data_()
+    {
+    }
+
+    T read()
+    {
+        T value;
+        uint64_t* dst = reinterpret_cast<uint64_t*>(&value);
+        for (;;) {
+            uint32_t begin = atomic_load_explicit(&seq_, __ATOMIC_ACQUIRE);
+            if (begin & 1) {
+                cpu_relax();
+                continue;
+            }
+            for (size_t i = 0; i < WORDS; i++)
+                dst[i] = atomic_load_explicit(&data_[i], __ATOMIC_RELAXED);
+            // Загрузки данных не должны переехать за повторное чтение версии
+            atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (atomic_load_explicit(&seq_, __ATOMIC_RELAXED) == begin)
+                return value;
+        }
+    }
+
+    void write(const T& value)
+    {
+        uint32_t seq = atomic_load_explicit(&seq_, __ATOMIC_RELAXED);
+        for (;;) {
+            if (seq & 1) {
+                cpu_relax();
+                seq = atomic_load_explicit(&seq_, __ATOMIC_RELAXED);
+                continue;
+            }
+            if (atomic_cas_bool(&seq_, &seq, seq + 1))
+                break;
+        }
+        // Нечётная версия должна стать видна раньше любых новых данных
+        atomic_thread_fence(__ATOMIC_RELEASE);
+        const uint64_t* src = reinterpret_cast<const uint64_t*>(&value);
+        for (size_t i = 0; i < WORDS; i++)
+            atomic_store_explicit(&data_[i], src[i], __ATOMIC_RELAXED);
+        atomic_store_explicit(&seq_, seq + 2, __ATOMIC_RELEASE);
+    }
+
+private:
+    static const size_t WORDS = sizeof(T) / sizeof(uint64_t);
+
+    alignas(CACHE_LINE_SIZE) volatile uint32_t seq_;
+    volatile uint64_t data_[WORDS];
+};
@@ -315,29 +315,46 @@
  * atomic_fetch_sub
  */
 
-#define atomic_fetch_sub(obj, arg) __atomic_op("amoadd", obj, -arg, __ATOMIC_SEQ_CST)
-#define atomic_fetch_sub_explicit(obj, arg, order) __atomic_op("amoadd", obj, -arg, order)
+#define atomic_fetch_sub(obj, arg) __atomic_op("amoadd", obj, -(arg), __ATOMIC_SEQ_CST)
+#define atomic_fetch_sub_explicit(obj, arg, order) __atomic_op("amoadd", obj, -(arg), order)
 
 /*
  * atomic_fetch_or
  */
 
-#define atomic_fetch_or(obj, arg) __atomic_op("amoor", obj, -arg, __ATOMIC_SEQ_CST)
-#define atomic_fetch_or_explicit(obj, arg, order) __atomic_op("amoor", obj, -arg, order)
+#define atomic_fetch_or(obj, arg) __atomic_op("amoor", obj, arg, __ATOMIC_SEQ_CST)
+#define atomic_fetch_or_explicit(obj, arg, order) __atomic_op("amoor", obj, arg, order)
 
 /*
  * atomic_fetch_xor
  */
 
-#define atomic_fetch_xor(obj, arg) __atomic_op("amoxor", obj, -arg, __ATOMIC_SEQ_CST)
-#define atomic_fetch_xor_explicit(obj, arg, order) __atomic_op("amoxor", obj, -arg, order)
+#define atomic_fetch_xor(obj, arg) __atomic_op("amoxor", obj, arg, __ATOMIC_SEQ_CST)
+#define atomic_fetch_xor_explicit(obj, arg, order) __atomic_op("amoxor", obj, arg, order)
 
 /*
  * atomic_fetch_and
  */
 
-#define atomic_fetch_and(obj, arg) __atomic_op("amoand", obj, -arg, __ATOMIC_SEQ_CST)
-#define atomic_fetch_and_explicit(obj, arg, order) __atomic_op("amoand", obj, -arg, order)
+#define atomic_fetch_and(obj, arg) __atomic_op("amoand", obj, arg, __ATOMIC_SEQ_CST)
+#define atomic_fetch_and_explicit(obj, arg, order) __atomic_op("amoand", obj, arg, order)
+
+/*
+ * atomic_fetch_min / atomic_fetch_max
+ *
+ * amomin/amomax compare as signed, amominu/amomaxu as unsigned; the variant
+ * is picked from the signedness of *obj.
+ */
+
+#define __atomic_is_signed(obj) ((__typeof__(*(obj)))-1 < 0)
+
+#define atomic_fetch_min_explicit(obj, arg, order) \
+    (__atomic_is_signed(obj) ? __atomic_op("amomin", obj, arg, order) : __atomic_op("amominu", obj, arg, order))
+#define atomic_fetch_min(obj, arg) atomic_fetch_min_explicit(obj, arg, __ATOMIC_SEQ_CST)
+
+#define atomic_fetch_max_explicit(obj, arg, order) \
+    (__atomic_is_signed(obj) ? __atomic_op("amomax", obj, arg, order) : __atomic_op("amomaxu", obj, arg, order))
+#define atomic_fetch_max(obj, arg) atomic_fetch_max_explicit(obj, arg, __ATOMIC_SEQ_CST)
 
 /*
  * atomic_flag_test_and_set
@@ -480,6 +497,15 @@
 
 #define atomic_thread_fence(order) __atomic_thread_fence_asm(order)
 
+/*
+ * atomic_thread_fence_tso
+ *
+ * fence.tso orders everything except an earlier store with a later load,
+ * which is enough for acquire, release and acq_rel fences.
+ */
+
+#define atomic_thread_fence_tso() __asm__ volatile("fence.tso" ::: "memory")
+
 /*
  * atomic_signal_fence
  */
@@ -490,6 +516,67 @@
 
 #ifdef __x86_64
 
+/*
+ * Atomic Load
+ *
+ * Plain mov is already acquire on x86 (TSO), so every order maps to it.
+ */
+#define atomic_load_explicit(obj, order)                                                   \
+    __extension__({                                                                        \
+        __typeof__(*(obj)) __result;                                                       \
+        switch (sizeof(__typeof__(*obj))) {                                                \
+        case 1:                                                                            \
+            __asm__ __volatile__("movb %1, %0" : "=q"(__result) : "m"(*(obj)) : "memory"); \
+            break;                                                                         \
+        case 2:                                                                            \
+            __asm__ __volatile__("movw %1, %0" : "=r"(__result) : "m"(*(obj)) : "memory"); \
+            break;                                                                         \
+        case 4:                                                                            \
+            __asm__ __volatile__("movl %1, %0" : "=r"(__result) : "m"(*(obj)) : "memory"); \
+            break;                                                                         \
+        case 8:                                                                            \
+            __asm__ __volatile__("movq %1, %0" : "=r"(__result) : "m"(*(obj)) : "memory"); \
+            break;                                                                         \
+        }                                                                                  \
+        __result;                                                                          \
+    })
+
+#define atomic_load(obj) atomic_load_explicit(obj, __ATOMIC_SEQ_CST)
+
+/*
+ * Atomic Store
+ *
+ * Release and relaxed stores are a plain mov, seq_cst uses xchg (implicit lock).
+ */
+#define __atomic_store_mov(obj, value)                                                    \
+    __extension__({                                                                       \
+        __typeof__(*(obj)) __value = (value);                                             \
+        switch (sizeof(__typeof__(*obj))) {                                               \
+        case 1:                                                                           \
+            __asm__ __volatile__("movb %1, %0" : "=m"(*(obj)) : "q"(__value) : "memory"); \
+            break;                                                                        \
+        case 2:                                                                           \
+            __asm__ __volatile__("movw %1, %0" : "=m"(*(obj)) : "r"(__value) : "memory"); \
+            break;                                                                        \
+        case 4:                                                                           \
+            __asm__ __volatile__("movl %1, %0" : "=m"(*(obj)) : "r"(__value) : "memory"); \
+            break;                                                                        \
+        case 8:                                                                           \
+            __asm__ __volatile__("movq %1, %0" : "=m"(*(obj)) : "r"(__value) : "memory"); \
+            break;                                                                        \
+        }                                                                                 \
+    })
+
+#define atomic_store_explicit(obj, value, order) \
+    __extension__({                              \
+        if ((order) == __ATOMIC_SEQ_CST)         \
+            (void)atomic_exchange(obj, value);   \
+        else                                     \
+            __atomic_store_mov(obj, value);      \
+    })
+
+#define atomic_store(obj, value) atomic_store_explicit(obj, value, __ATOMIC_SEQ_CST)
+
 /*
  * Atomic Compare and Exchange
  */
@@ -579,6 +666,11 @@
         __ret;                                                                                  \
     })
 
+/*
+ * Atomic Fetch Sub
+ */
+#define atomic_fetch_sub(obj, arg) atomic_fetch_add(obj, -(arg))
+
 /*
  * Atomic Fetch And/Or/Xor (CAS loop implementation)
  */
@@ -596,4 +688,111 @@
 #define atomic_fetch_or(obj, arg) __atomic_fetch_op(|, obj, arg)
 #define atomic_fetch_xor(obj, arg) __atomic_fetch_op(^, obj, arg)
 
+/*
+ * Atomic Fetch Min/Max (CAS loop with early exit, see atomic_fetch_min_cas)
+ */
+#define atomic_fetch_min(obj, arg) atomic_fetch_min_cas(obj, arg)
+#define atomic_fetch_max(obj, arg) atomic_fetch_max_cas(obj, arg)
+
+/*
+ * Explicit memory order variants
+ *
+ * Every lock-prefixed instruction is a full barrier, so the order is ignored.
+ */
+#define atomic_compare_exchange_strong_explicit(obj, exp, val, succ, fail) atomic_compare_exchange_strong(obj, exp, val)
+#define atomic_compare_exchange_weak(obj, exp, val) atomic_compare_exchange_strong(obj, exp, val)
+#define atomic_compare_exchange_weak_explicit(obj, exp, val, succ, fail) atomic_compare_exchange_strong(obj, exp, val)
+#define atomic_exchange_explicit(obj, arg, order) atomic_exchange(obj, arg)
+#define atomic_fetch_add_explicit(obj, arg, order) atomic_fetch_add(obj, arg)
+#define atomic_fetch_sub_explicit(obj, arg, order) atomic_fetch_sub(obj, arg)
+#define atomic_fetch_and_explicit(obj, arg, order) atomic_fetch_and(obj, arg)
+#define atomic_fetch_or_explicit(obj, arg, order) atomic_fetch_or(obj, arg)
+#define atomic_fetch_xor_explicit(obj, arg, order) atomic_fetch_xor(obj, arg)
+#define atomic_fetch_min_explicit(obj, arg, order) atomic_fetch_min_cas(obj, arg)
+#define atomic_fetch_max_explicit(obj, arg, order) atomic_fetch_max_cas(obj, arg)
+
+/*
+ * Atomic Thread Fence
+ *
+ * TSO only reorders a store with a later load, so seq_cst needs mfence and the
+ * other orders only have to stop the compiler.
+ */
+#define atomic_thread_fence(order)                       \
+    __extension__({                                      \
+        if ((order) == __ATOMIC_SEQ_CST)                 \
+            __asm__ __volatile__("mfence" ::: "memory"); \
+        else                                             \
+            __asm__ __volatile__("" ::: "memory");       \
+    })
+
+#define atomic_signal_fence(order) __asm__ __volatile__("" ::: "memory")
+
+/*
+ * TSO Fence (the hardware already provides TSO ordering)
+ */
+#define atomic_thread_fence_tso() __asm__ __volatile__("" ::: "memory")
+
 #endif /* defined(__x86_64) */
+
+/*
+ * Padding unit for shared atomics that must not share a cache line
+ */
+
+#define CACHE_LINE_SIZE 64
+
+/*
+ * cpu_relax
+ *
+ * Hint for the body of a spin-wait loop.
+ * On RISC-V this is pause from Zihintpause, encoded as fence w,0, which is a
+ * nop on cores without the extension.
+ */
+
+#if defined(__x86_64)
+#define cpu_relax() __asm__ __volatile__("pause" ::: "memory")
+#elif defined(__riscv)
+#define cpu_relax() __asm__ volatile(".word 0x0100000f" ::: "memory")
+#endif
+
+/*
+ * atomic_cas_bool / atomic_cas_bool_explicit
+ *
+ * atomic_compare_exchange_strong returns the old value on RISC-V and a success
+ * flag on x86-64. This wrapper gives both backends the C11 contract: returns
+ * true on success, otherwise stores the observed value into *exp.
+ */
+
+#if defined(__riscv)
+#define atomic_cas_bool_explicit(obj, exp, val, succ, fail)                                                \
+    __extension__({                                                                                        \
+        __typeof__(*(obj)) __cas_expected = *(exp);                                                        \
+        __typeof__(*(obj)) __cas_old = atomic_compare_exchange_strong_explicit(obj, exp, val, succ, fail); \
+        *(exp) = __cas_old;                                                                                \
+        __cas_old == __cas_expected;                                                                       \
+    })
+#elif defined(__x86_64)
+#define atomic_cas_bool_explicit(obj, exp, val, succ, fail) \
+    atomic_compare_exchange_strong_explicit(obj, exp, val, succ, fail)
+#endif
+
+#define atomic_cas_bool(obj, exp, val) atomic_cas_bool_explicit(obj, exp, val, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+
+/*
+ * atomic_fetch_min_cas / atomic_fetch_max_cas
+ *
+ * CAS-loop min/max for both backends. The loop exits without writing as soon
+ * as the stored value already satisfies the bound, so a settled high-water
+ * mark costs a single load. On RISC-V it is kept as the baseline for amomin/amomax.
+ */
+
+#define __atomic_fetch_minmax_cas(cmp, obj, arg)                                 \
+    __extension__({                                                              \
+        __typeof__(*(obj)) __bound = (arg);                                      \
+        __typeof__(*(obj)) __seen = atomic_load_explicit(obj, __ATOMIC_RELAXED); \
+        while (__bound cmp __seen && !atomic_cas_bool(obj, &__seen, __bound)) {  \
+        }                                                                        \
+        __seen;                                                                  \
+    })
+
+#define atomic_fetch_min_cas(obj, arg) __atomic_fetch_minmax_cas(<, obj, arg)
+#define atomic_fetch_max_cas(obj, arg) __atomic_fetch_minmax_cas(>, obj, arg)